@@ -3,46 +3,43 @@
 
 #include <random>
 #include <algorithm>
+#include <chrono>
 
 #include "graph_lite.hpp"
+#include "mtt.hpp"
 
-ApproxCountST::ApproxCountST(GraphLite* gl) : ps_vec(gl->edge_count_all()), gl(gl), N_initial(gl->vertex_count_all()), M_initial(gl->edge_count_all()), K(M_initial)
+template<typename graph_t>
+BasicApproxCountST<graph_t>::BasicApproxCountST(graph_t* gl, unsigned long seed) : gl(gl), rng(seed), N_initial(gl->vertex_count_all()), M_initial(gl->edge_count_all()), K(M_initial)
 {
-    assert(M_initial >= N_initial-1);
+    assert(M_initial + 1 >= N_initial);
 
-    printf("Approximate Count ST initialised with a graph of %d vertices and %d edges\n", N_initial, M_initial);
-    printf("Iterations of ratio estimators to run: %d rounds\n", K);
+    printf("Approximate Count ST initialised with a graph of %llu vertices and %llu edges\n", (unsigned long long)N_initial, (unsigned long long)M_initial);
+    printf("Iterations of ratio estimators to run: %zu rounds\n", K);
+
+    ps.resize(K);
+    pivot_valid.assign(K, 0);
 }
 
 
 
-ApproxCountST::result_t ApproxCountST::approx_count_st()
+template<typename graph_t>
+template<typename engine_t>
+typename BasicApproxCountST<graph_t>::result_t BasicApproxCountST<graph_t>::approx_count_st(const budget_t& budget, const progress_callback_t& on_progress)
 {
     printf("approx_count_st...\n");
-    // Obtain a shuffled edge sequence, or just iterate as per original sequence
-
-    e_shuffle.resize(M_initial);
-    for(int i = 0 ; i < M_initial; i++)
-        e_shuffle[i] = i;
+    // Obtain the pivot sequence, as original edge ids, by the edge_order strategy
+    order_edges();
 
-    const bool do_shuffle_edges = false;
-    if(do_shuffle_edges)
-    {
-        std::random_device rd;
-        std::mt19937 gen(rd());
+    // pivots are named by the original edge ids, also when the graph has been reordered
+    for(size_t k = 0 ; k < K; k++)
+        ps.eid[k] = gl->edge_of_original(e_order[k]);
 
-        std::shuffle(e_shuffle.begin(), e_shuffle.end(), gen);
+    pivot_valid_upto = 0;
 
-        // so far all ps_vec element's mode should be UNSPECIFIED
-    }
-
-    for(int i = 0 ; i < M_initial; i++)
-        ps_vec[e_shuffle[i]].eid = i;
-
-    printf("ps_vec[i].eid done...\n");
+    printf("ps.eid[k] done, edge order %d...\n", edge_order);
     
     // Initialise Random Spanning Tree Sampler
-    RandomSpanningTrees rst(gl);
+    sampler_t rst(gl, rng());
 
     printf("rst initialised...\n");
 
@@ -54,47 +51,123 @@ ApproxCountST::result_t ApproxCountST::approx_count_st()
     sampling_struct_t sampling_struct;
     sampling_struct.next.resize(N_initial);
     sampling_struct.in_tree.resize(N_initial);
-
-    for(int k = 0; k < K ; )
+    sampling_struct.in_path.assign(M_initial + 3, 0);
+
+    size_t k_end = K; // pivots from k_end on are counted on the residual graph
+    double tail_log = 0.0;
+    double tail_variance = 0.0;
+    bool tail_estimated = false; // by SLQ, otherwise exact
+    bool budget_exhausted = false;
+
+    LaplacianSolver<graph_t> solver(resistance_tolerance);
+    long long solver_iterations = 0;
+
+    // budget and progress
+    const auto begin = std::chrono::steady_clock::now();
+    auto elapsed = [&](){return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();};
+    long long samples_drawn = 0;
+    long long forced_pivots = 0;
+    size_t share_pivot = K; // pivot the current share of the budget is for
+    double share_seconds_end = 0.0, share_samples_end = 0.0;
+
+    progress_t progress;
+    progress.pivots = K;
+    double progress_variance = 0.0;
+
+    // account for pivot k once its ratio is final
+    auto pivot_done = [&](size_t k){
+        if(!on_progress)
+            return;
+        progress.pivot = k + 1;
+        progress.count_log += std::log(1.0 / ps.ratio[k]);
+        progress_variance += ratio_log_variance(ps.ratio[k], ps.total[k]);
+        progress.count_log_std_error = std::sqrt(progress_variance);
+        progress.samples = samples_drawn;
+        progress.seconds = elapsed();
+        progress.budget_used = std::max(budget.seconds > 0.0 ? progress.seconds / budget.seconds : 0.0,
+                                        budget.samples > 0 ? samples_drawn / (double)budget.samples : 0.0);
+        on_progress(progress);
+    };
+
+    for(size_t k = 0; k < K ; )
     {
+        // the residual graph is small enough for an exact count, which stands for all remaining ratios
+        if(exact_tail_reached()){
+            k_end = k;
+            tail_log = residual_logdet();
+            printf("\nExact count of the residual graph of %llu vertices and %llu edges at pivot %zu: e^%.4e\n",
+                (unsigned long long)gl->vertex_count(), (unsigned long long)gl->edge_count(), k, tail_log);
+            break;
+        }
+
+        // out of budget, the residual graph stands for the remaining ratios, counted by SLQ if too large for MTT
+        if(budget.limited() && ((budget.seconds > 0.0 && elapsed() >= budget.seconds) || (budget.samples > 0 && samples_drawn >= budget.samples))){
+            k_end = k;
+            budget_exhausted = true;
+            if(gl->vertex_count() <= (vid_t)BUDGET_EXACT_TAIL_VERTICES)
+                tail_log = residual_logdet();
+            else{
+                const auto slq = SLQLogDet<graph_t>(32, 64, 1, rng()).estimate(gl);
+                tail_log = slq.logdet;
+                tail_variance = slq.std_error * slq.std_error;
+                tail_estimated = true;
+            }
+            printf("\nBudget exhausted at pivot %zu, residual graph of %llu vertices and %llu edges counted %s: e^%.4e\n",
+                k, (unsigned long long)gl->vertex_count(), (unsigned long long)gl->edge_count(), tail_estimated ? "by SLQ" : "exactly", tail_log);
+            break;
+        }
+
         // TODO: make it more streamlined
         // if the edge is invalid, means some other present edge has contracted this one, so the ratio automatically should be 1
-        if(!gl->is_edge_valid(ps_vec[k].eid)){
+        if(!gl->is_edge_valid(ps.eid[k])){
             
-            printf("short circuiting edge %d, as the edge has been contracted by others before...\n", ps_vec[k].eid);
+            printf("short circuiting edge %llu, as the edge has been contracted by others before...\n", (unsigned long long)ps.eid[k]);
             
             // possible to have ratio = -1, uninitialised, as we contract it before it got even attempted.
-            if (ps_vec[k].ratio == -1.0)
-                ps_vec[k].ratio = 1.0;
-            assert(ps_vec[k].ratio == 1.0);
+            if (ps.ratio[k] == -1.0)
+                ps.ratio[k] = 1.0;
+            assert(ps.ratio[k] == 1.0);
+            pivot_done(k);
             k++;
             continue;
         }
         
-        const auto e = gl->edge(ps_vec[k].eid);
+        // one solve stands for all the samples of the pivot
+        if(ratio_engine == ENGINE_RESISTANCE){
+            resistance_ratio(k, &solver, &solver_iterations);
+            apply_pivot(k);
+            pivot_done(k);
+            k++;
+            continue;
+        }
+
+        const auto e = gl->edge(ps.eid[k]);
 
-        //// Logging the ripple sample count if required
-        if(!ps_vec[k].total)
+        //// Logging the ripple sample count if required, the progress callback replaces the printing
+        if(!ps.total[k])
         {
-            printf("\nEdge %d (%d->%d)\n",ps_vec[k].eid, e.from, e.to);
-            ps_vec[k].rippled_total = -1;
+            if(!on_progress)
+                printf("\nEdge %llu (%llu->%llu)\n", (unsigned long long)ps.eid[k], (unsigned long long)e.from, (unsigned long long)e.to);
+            ps.rippled_total[k] = -1;
 
-            if(k != 0){
-                ps_vec[k].print();
+            // pivots after the first always got rippled samples, unless the one before was forced early
+            if(k != 0 && !budget.limited()){
+                ps.print(k);
                 abort();
             }
         }
-        else if(!ps_vec[k].rippled_total)
+        else if(!ps.rippled_total[k])
         {
-            printf("\n[%.1lf%%] Edge %d (%d->%d) with existing %d rippled samples (count = %d), mode %d\n ", 
-            100.0 * (k+1)/ K, ps_vec[k].eid, e.from, e.to,  ps_vec[k].total, ps_vec[k].update_count, ps_vec[k].count_mode);
+            if(!on_progress)
+                printf("\n[%.1lf%%] Edge %llu (%llu->%llu) with existing %d rippled samples (count = %d), mode %d\n ", 
+                100.0 * (k+1)/ K, (unsigned long long)ps.eid[k], (unsigned long long)e.from, (unsigned long long)e.to,  ps.total[k], ps.update_count[k], ps.count_mode[k]);
 
-            ps_vec[k].rippled_total = ps_vec[k].total;
+            ps.rippled_total[k] = ps.total[k];
             // Good! Enough samples were obtained to output past stats
-            if(ps_vec[k].update_count >= PIVOT_BUFFER_SIZE){
+            if(!on_progress && ps.update_count[k] >= PIVOT_BUFFER_SIZE){
                 printf("Past ratio buffer:");
-                for(auto e : ps_vec[k].inverse_ratio_buffer)
-                    printf("%.3lf ", e);
+                for(int i = 0; i < PIVOT_BUFFER_SIZE; i++)
+                    printf("%.3lf ", ps.buffer(k)[i]);
                 printf("\n");
             }
         }
@@ -103,122 +176,365 @@ ApproxCountST::result_t ApproxCountST::approx_count_st()
         // k will increment if convergence is checked
         // This check is before the first ever sampling is done
         if (check_convergence(&k)){
+            rst.discard_buffered(); // trees drawn ahead are of the graph before the change
+            pivot_done(k);
             k++;
             continue;
         }
-    
-        sample_mini_batch_with_updates(&rst, k, &sampling_struct); // affected by random_walk_mode
-        printf(".");
-        fflush(stdout);
+
+        if(budget.limited()){
+            // an equal share of what is left, for each of the valid edges left
+            if(share_pivot != k){
+                share_pivot = k;
+                const double remaining = std::max<eid_t>(1, gl->edge_count());
+                share_seconds_end = elapsed() + (budget.seconds - elapsed()) / remaining;
+                share_samples_end = samples_drawn + (budget.samples - samples_drawn) / remaining;
+            }
+
+            const bool share_used = (budget.seconds > 0.0 && elapsed() >= share_seconds_end)
+                                 || (budget.samples > 0 && samples_drawn >= share_samples_end);
+            if(share_used && ps.present[k] + ps.absent[k] > 0){
+                force_pivot(k);
+                forced_pivots++;
+                rst.discard_buffered();
+                pivot_done(k);
+                k++;
+                continue;
+            }
+        }
+
+        samples_drawn += ps.requested_batch_size[k];
+        sample_mini_batch_with_updates<engine_t>(&rst, k, &sampling_struct); // affected by random_walk_mode
+        if(!on_progress){
+            printf(".");
+            fflush(stdout);
+        }
     }
 
     // Prepare final result
-    assert( ps_vec[K-1].ratio == 1.0);
+    assert(k_end < K || ps.ratio[K-1] == 1.0);
 
     result_t res;
-    res.count = 1.0;
+    res.solver_iterations = solver_iterations;
+    res.forced_pivots = forced_pivots;
+    res.budget_exhausted = budget_exhausted;
+    res.count = std::exp(tail_log);
+    res.count_log = tail_log;
+    if(k_end < K && tail_estimated)
+        res.estimated_tail_pivot = k_end;
+    else if(k_end < K){
+        res.exact_tail_pivot = k_end;
+        res.exact_tail_log = tail_log;
+    }
 
-    for (int k = 0; k < K; k++)
+    double variance = tail_variance;
+    for (size_t k = 0; k < k_end; k++)
     {
-        assert(ps_vec[k].ratio > 0.1);
-        res.count *= 1/ps_vec[k].ratio;
-        res.count_log += std::log(1/ps_vec[k].ratio);
-        res.effective_samples += ps_vec[k].total;
-        res.actual_samples += ps_vec[k].total - ps_vec[k].rippled_total;
+        assert(ps.ratio[k] > 0.1);
+        res.count *= 1/ps.ratio[k];
+        res.count_log += std::log(1/ps.ratio[k]);
+        res.effective_samples += ps.total[k];
+        res.actual_samples += ps.total[k] - ps.rippled_total[k];
+        variance += ratio_log_variance(ps.ratio[k], ps.total[k]);
     }
+    res.count_log_std_error = std::sqrt(variance);
     printf("approx_count_st COMPLETED...\n");
     return res;
 }
 
-inline bool ApproxCountST::check_convergence(eid_t* pk)
+template<typename graph_t>
+inline bool BasicApproxCountST<graph_t>::check_convergence(size_t* pk)
 {
-    eid_t& k = *pk;
-    assert(k >= 0 && k < K);
-    if (ps_vec[k].converged()){
+    size_t& k = *pk;
+    assert(k < K);
+    if (ps.converged(k)){
 
-        printf("%d-th of %d ratio converged to %.3lf\n", k + 1, K, ps_vec[k].ratio);
-
-        // make graph changes
-        switch(ps_vec[k].count_mode){
-            case PRESENCE:
-                // to contract the edge
-                gl->contract_edge(ps_vec[k].eid);
-                break;
-            case ABSENCE:
-                // to delete the edge in the incident list
-                gl->remove_edge(ps_vec[k].eid);
-                break;
-            default:
-                assert(0); // should never come here
-        }
+        printf("%zu-th of %zu ratio converged to %.3lf\n", k + 1, K, ps.ratio[k]);
 
+        apply_pivot(k);
         return true;
     }
 
     return false;
 }
 
+template<typename graph_t>
+inline void BasicApproxCountST<graph_t>::apply_pivot(size_t k)
+{
+    // make graph changes
+    switch(ps.count_mode[k]){
+        case PRESENCE:
+            // to contract the edge
+            gl->contract_edge(ps.eid[k]);
+            break;
+        case ABSENCE:
+            // to delete the edge in the incident list
+            gl->remove_edge(ps.eid[k]);
+            break;
+        default:
+            assert(0); // should never come here
+    }
+
+    // pivots after k might have been contracted away or removed
+    pivot_valid_upto = std::min(pivot_valid_upto, k + 1);
+}
+
+template<typename graph_t>
+void BasicApproxCountST<graph_t>::force_pivot(size_t k)
+{
+    ps.total[k] = ps.present[k] + ps.absent[k];
+    assert(ps.total[k] > 0);
+
+    // the more likely outcome, as try_set_count_mode would, once there are enough samples
+    if(ps.count_mode[k] == UNSPECIFIED)
+        ps.count_mode[k] = 2 * ps.present[k] > ps.total[k] ? PRESENCE : ABSENCE;
+
+    ps.ratio[k] = (ps.count_mode[k] == PRESENCE ? ps.present[k] : ps.absent[k]) / (double)ps.total[k];
+
+    // a mode chosen from a full presample could be the minority outcome now, keep the ratio away from 0
+    ps.ratio[k] = std::max(ps.ratio[k], 1.0 / (ps.total[k] + 1));
+
+    printf("%zu-th of %zu ratio forced to %.3lf after %d samples, out of its share of the budget\n", k + 1, K, ps.ratio[k], ps.total[k]);
+    apply_pivot(k);
+}
+
+template<typename graph_t>
+void BasicApproxCountST<graph_t>::resistance_ratio(size_t k, LaplacianSolver<graph_t>* solver, long long* iterations)
+{
+    double r = 1.0; // a tree, every edge is a bridge
+    long long solve_iterations = 0;
+    if(gl->edge_count() + 1 != gl->vertex_count()){
+        solver->build(gl);
+        r = solver->effective_resistance(ps.eid[k], &solve_iterations);
+        r = std::min(1.0, std::max(0.0, r));
+    }
+    *iterations += solve_iterations;
+
+    // the more likely outcome, as for the sampled pivots
+    if(r > 0.5){
+        ps.count_mode[k] = PRESENCE;
+        ps.ratio[k] = r;
+    }
+    else{
+        ps.count_mode[k] = ABSENCE;
+        ps.ratio[k] = 1.0 - r;
+    }
+
+    printf("%zu-th of %zu ratio solved to %.3lf (resistance %.6lf, %lld iterations)\n", k + 1, K, ps.ratio[k], r, solve_iterations);
+}
+
+template<typename graph_t>
+void BasicApproxCountST<graph_t>::order_edges()
+{
+    e_order.resize(M_initial);
+    for(eid_t i = 0 ; i < M_initial; i++)
+        e_order[i] = i;
+
+    if(edge_order == ORDER_IDENTITY)
+        return;
+
+    if(edge_order == ORDER_SHUFFLE){
+        std::shuffle(e_order.begin(), e_order.end(), rng);
+        return;
+    }
+
+    if(edge_order == ORDER_LOCALITY){
+        // vertices ranked by a BFS from a random vertex, edges by the ranks of their endpoints
+        std::vector<vid_t> rank(N_initial, graph_t::NO_VERTEX), queue;
+
+        const vid_t root = gl->random_connected_vertex(rng);
+        rank[root] = 0;
+        queue.push_back(root);
+        for(size_t head = 0; head < queue.size(); head++){
+            const vid_t u = queue[head];
+            for(auto e : gl->inclist()[u]){
+                const vid_t w = gl->edge_other_end(e, u);
+                if(rank[w] == graph_t::NO_VERTEX){
+                    rank[w] = queue.size();
+                    queue.push_back(w);
+                }
+            }
+        }
+
+        auto key = [&](eid_t e){
+            const auto& ends = gl->edge(gl->edge_of_original(e));
+            const vid_t a = rank[ends.from], b = rank[ends.to];
+            return std::make_pair(std::min(a, b), std::max(a, b));
+        };
+        std::stable_sort(e_order.begin(), e_order.end(), [&](eid_t a, eid_t b){return key(a) < key(b);});
+        return;
+    }
+
+    // estimated probability of each edge (original id) to be in a uniform spanning tree
+    std::vector<double> presence(M_initial, 0.0);
+
+    if(edge_order == ORDER_DEGREE){
+        // 1/d_u + 1/d_v, the effective resistance when both ends only connect through their other neighbours at no cost
+        std::vector<int> degree(N_initial, 0);
+        for(const auto& e : gl->edge_list()){
+            degree[e.from]++;
+            degree[e.to]++;
+        }
+        for(eid_t e = 0; e < M_initial; e++){
+            const auto& ends = gl->edge(gl->edge_of_original(e));
+            presence[e] = std::min(1.0, 1.0 / degree[ends.from] + 1.0 / degree[ends.to]);
+        }
+    }
+    else{
+        assert(edge_order == ORDER_PRESAMPLE);
+
+        // edge frequencies in a batch of trees, these samples are not used by the estimator
+        sampler_t rst(gl, rng());
+        std::vector<eid_t> path, next(N_initial);
+        std::vector<bool> in_tree(N_initial);
+        const int T = initial_requested_batch_size;
+        for(int t = 0; t < T; t++){
+            rst.wilsons_get_st(&path, gl->random_connected_vertex(rng), &next, &in_tree);
+            for(auto e : path)
+                presence[gl->original_edge(e)] += 1.0 / T;
+        }
+    }
+
+    // the most certain edges first, present ones then absent ones, so that pivots of one count mode come in runs
+    std::stable_sort(e_order.begin(), e_order.end(), [&](eid_t a, eid_t b){return presence[a] > presence[b];});
+}
+
+template<typename graph_t>
+inline bool BasicApproxCountST<graph_t>::exact_tail_reached()
+{
+    return (exact_tail_vertex_threshold > 0 && gl->vertex_count() <= (vid_t)exact_tail_vertex_threshold)
+        || (exact_tail_edge_threshold > 0 && gl->edge_count() <= (eid_t)exact_tail_edge_threshold);
+}
+
+template<typename graph_t>
+double BasicApproxCountST<graph_t>::residual_logdet()
+{
+    const vid_t n = gl->vertex_count();
+    if(n <= 1)
+        return 0.0;
+
+    // number the live vertices, in LAZY mode the endpoints are resolved to them with find()
+    std::vector<vid_t> index(gl->vertex_count_all(), graph_t::NO_VERTEX);
+    vid_t i = 0;
+    for(vid_t v = 0; v < gl->vertex_count_all(); v++)
+        if(gl->is_vertex_alive(v))
+            index[v] = i++;
+    assert(i == n);
+
+    // every valid edge is one concrete edge, also when parallel edges are collapsed
+    Eigen::MatrixXd laplacian = Eigen::MatrixXd::Zero(n, n);
+    for(eid_t e = 0; e < gl->edge_count_all(); e++){
+        if(!gl->is_edge_valid(e))
+            continue;
+        const vid_t a = index[gl->find(gl->edge(e).from)];
+        const vid_t b = index[gl->find(gl->edge(e).to)];
+        assert(a != graph_t::NO_VERTEX && b != graph_t::NO_VERTEX && a != b);
+        laplacian(a, a) += 1;
+        laplacian(b, b) += 1;
+        laplacian(a, b) -= 1;
+        laplacian(b, a) -= 1;
+    }
+
+    return logdet(laplacian.topLeftCorner(n-1, n-1), true);
+}
+
+template<typename graph_t>
+inline void BasicApproxCountST<graph_t>::refresh_pivot_valid(size_t k_end)
+{
+    for(; pivot_valid_upto < k_end; pivot_valid_upto++)
+        pivot_valid[pivot_valid_upto] = gl->is_edge_valid(ps.eid[pivot_valid_upto]);
+}
+
 // Draw new samples starting from index k
-void ApproxCountST::sample_mini_batch_with_updates(RandomSpanningTrees* rst, int k_start, sampling_struct_t* sampling_struct)
+template<typename graph_t>
+template<typename engine_t>
+void BasicApproxCountST<graph_t>::sample_mini_batch_with_updates(sampler_t* rst, size_t k_start, sampling_struct_t* sampling_struct)
 {
-    assert(k_start >=0 && k_start < K);
-    const int BATCH_SIZE = ps_vec[k_start].requested_batch_size;
+    assert(k_start < K);
+    const int BATCH_SIZE = ps.requested_batch_size[k_start];
     // printf("mini_batch at [%d] for %d samples\n", k_start, BATCH_SIZE);
 
     // const vid_t root = gl->first_connected_vertex();
-    const vid_t root = gl->random_connected_vertex();
+    const vid_t root = gl->random_connected_vertex(rng);
+
+    auto& in_path = sampling_struct->in_path;
+    size_t ripple_end = k_start + 1;
+
+    // validity is only computed as far as the samples ripple
+    const size_t VALID_CHUNK = 256;
+    refresh_pivot_valid(std::min(K, k_start + VALID_CHUNK));
+    assert(pivot_valid[k_start]);
 
     // perform the batch sampling
     for (int i = 0 ; i < BATCH_SIZE ; i++)
 	{
-        rst->wilsons_get_st(&(sampling_struct->path), root, &(sampling_struct->next), &(sampling_struct->in_tree)); // NOTE: for now, always sample from the node 0
+        rst->template get_st<engine_t>(&(sampling_struct->path), root, &(sampling_struct->next), &(sampling_struct->in_tree)); // NOTE: for now, always sample from the node 0
+
+        for(auto e : sampling_struct->path)
+            in_path[e] = 1;
 
         // NOTE: change K to k_start + 1, to disable ripple feature
-        for(int k = k_start; k < K ;k++)
-        {
-            // If the edge is contracted away by edges before it, no need to update further!
-            if (!gl->is_edge_valid(ps_vec[k].eid))
-            {
-                assert(k!=k_start);
-                continue;
-            }
-            if ( sampling_struct->path.end() != std::find(sampling_struct->path.begin(), sampling_struct->path.end(), ps_vec[k].eid) ){
-                ps_vec[k].present++;
-                if(ps_vec[k].count_mode != PRESENCE)
-                    break; // We should not continue to update the downstreams in this case
-            }else{
-                ps_vec[k].absent++;
-                if(ps_vec[k].count_mode != ABSENCE)
-                    break; // We should not continue to update the downstreams in this case
-            }
+        // If the edge is contracted away by edges before it, it is skipped; stops at the first pivot not agreeing with its mode,
+        // as we should not continue to update the downstreams in this case
+        size_t k = k_start;
+        while(true){
+            k = pivot_kernels::ripple_sample(ps.eid.data(), ps.count_mode.data(), pivot_valid.data(), in_path.data(),
+                ps.present.data(), ps.absent.data(), k, pivot_valid_upto);
+            if(k < pivot_valid_upto || pivot_valid_upto == K)
+                break;
+            refresh_pivot_valid(std::min(K, pivot_valid_upto + VALID_CHUNK));
         }
+        ripple_end = std::max(ripple_end, k);
+
+        for(auto e : sampling_struct->path)
+            in_path[e] = 0;
 	}
 
 
-    // ripple update
-    for(int k = k_start; k < K ;k++)
+    // ripple update, pivots after ripple_end got no new samples
+    for(size_t k = k_start; k < ripple_end ;)
     {
+        // pivots with a count mode are updated in a batch, up to the first one without
+        const size_t k_unspecified = pivot_kernels::first_unspecified(ps.count_mode.data(), k, ripple_end);
+        for(; k < k_unspecified; k++)
+            if (pivot_valid[k])
+                ps.update(k);
 
-        // If the edge is contracted away by edges before it, no need to update further!
-        if (!gl->is_edge_valid(ps_vec[k].eid))
-            continue;
-        
-        ps_vec[k].update();
-
-        if(ps_vec[k].count_mode == UNSPECIFIED && !ps_vec[k].try_set_count_mode()){
+        if (k == ripple_end)
             break;
-        }
 
+        // If the edge is contracted away by edges before it, no need to update further!
+        if (pivot_valid[k]){
+            ps.update(k);
+            if(!ps.try_set_count_mode(k))
+                break;
+        }
+        k++;
     }
     
 }
 
-void ApproxCountST::print_all()
+template<typename graph_t>
+void BasicApproxCountST<graph_t>::print_all()
 {
-    for(int i=0;i<K;i++)
+    for(size_t i=0;i<K;i++)
     {
-        printf("%d: %.3lf(%d)\t", i, 1/ps_vec[i].ratio, ps_vec[i].total);
+        printf("%zu: %.3lf(%d)\t", i, 1/ps.ratio[i], ps.total[i]);
     }
 
     printf("\n");
-}
\ No newline at end of file
+}
+
+// both index widths, with all engines
+template class BasicApproxCountST<GraphLite>;
+template class BasicApproxCountST<GraphLite64>;
+
+template ApproxCountST::result_t ApproxCountST::approx_count_st<SamplerEngines::Wilson>(const ApproxCountST::budget_t&, const ApproxCountST::progress_callback_t&);
+template ApproxCountST::result_t ApproxCountST::approx_count_st<SamplerEngines::CyclePopping>(const ApproxCountST::budget_t&, const ApproxCountST::progress_callback_t&);
+template ApproxCountST::result_t ApproxCountST::approx_count_st<SamplerEngines::AldousBroder>(const ApproxCountST::budget_t&, const ApproxCountST::progress_callback_t&);
+template ApproxCountST::result_t ApproxCountST::approx_count_st<SamplerEngines::WilsonInterleaved>(const ApproxCountST::budget_t&, const ApproxCountST::progress_callback_t&);
+
+template ApproxCountST64::result_t ApproxCountST64::approx_count_st<SamplerEngines::Wilson>(const ApproxCountST64::budget_t&, const ApproxCountST64::progress_callback_t&);
+template ApproxCountST64::result_t ApproxCountST64::approx_count_st<SamplerEngines::CyclePopping>(const ApproxCountST64::budget_t&, const ApproxCountST64::progress_callback_t&);
+template ApproxCountST64::result_t ApproxCountST64::approx_count_st<SamplerEngines::AldousBroder>(const ApproxCountST64::budget_t&, const ApproxCountST64::progress_callback_t&);
+template ApproxCountST64::result_t ApproxCountST64::approx_count_st<SamplerEngines::WilsonInterleaved>(const ApproxCountST64::budget_t&, const ApproxCountST64::progress_callback_t&);
\ No newline at end of file
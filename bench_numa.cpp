@@ -0,0 +1,97 @@
+// Spanning trees per second of pinned threads sampling one graph, with one replica per NUMA node against a single
+// shared copy, on the sparse family; an edge is contracted on all replicas between rounds, as a pivot converging would
+#include <graph_lite.hpp>
+#include <graph_lite_generator.hpp>
+#include <numa_replication.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <atomic>
+
+typedef struct bench_result{
+    double trees_per_second = 0.0;
+    double mutation_ms = 0.0; // mean time to contract an edge on all replicas
+    long long edges = 0; // tree edges seen, so that no configuration skips work
+}bench_result_t;
+
+bench_result_t bench_config(const GraphLite& base, const NumaTopology& topology, bool replicate, bool pin, int threads, long long T, int rounds)
+{
+    ReplicatedGraph<GraphLite> graphs(base, topology, replicate);
+    ParallelTreeSampler<GraphLite> sampler(&graphs, threads, 1, pin);
+
+    std::atomic<long long> edges(0);
+    auto count_edges = [&](int, const std::vector<eid_t>& tree){edges += tree.size();};
+
+    // draws the first trees, so that the walk state of every worker exists before timing
+    sampler.sample(threads, count_edges);
+
+    const eid_t M = graphs.replica(0)->edge_count_all();
+    std::mt19937_64 rng(7);
+    double sample_seconds = 0.0, mutation_seconds = 0.0;
+
+    for(int r = 0; r < rounds; r++){
+        auto begin = std::chrono::steady_clock::now();
+        sampler.sample(T, count_edges);
+        auto end = std::chrono::steady_clock::now();
+        sample_seconds += std::chrono::duration<double>(end - begin).count();
+
+        // same edges in every configuration, as the stream is restarted
+        eid_t e;
+        do{
+            e = std::uniform_int_distribution<eid_t>(0, M - 1)(rng);
+        }while(!graphs.replica(0)->is_edge_valid(e));
+
+        begin = std::chrono::steady_clock::now();
+        graphs.contract_edge(e);
+        sampler.discard_buffered();
+        end = std::chrono::steady_clock::now();
+        mutation_seconds += std::chrono::duration<double>(end - begin).count();
+    }
+
+    bench_result_t res;
+    res.trees_per_second = T * rounds / sample_seconds;
+    res.mutation_ms = mutation_seconds / rounds * 1e3;
+    res.edges = edges;
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        printf("Usage: %s NUM_OF_VERTICES NUM_OF_THREADS [TREES_PER_ROUND] [ROUNDS]\n", argv[0]);
+        return 1;
+    }
+
+    const vid_t N = atoi(argv[1]);
+    const int threads = std::max(1, atoi(argv[2]));
+    const long long T = argc >= 4 ? atoll(argv[3]) : 200;
+    const int rounds = argc >= 5 ? atoi(argv[4]) : 5;
+
+    NumaTopology topology;
+    printf("%d NUMA nodes:", topology.node_count());
+    for(int n = 0; n < topology.node_count(); n++)
+        printf(" node%d (%zu cpus)", topology.node(n).id, topology.node(n).cpus.size());
+    printf("\n");
+
+    // average degree about 5, as the sparse graphs of main.cpp
+    GraphLite base(N, graph_lite_generator::connected_gnp_edges(N, 3.0 / N, 123));
+
+    const char* names[] = {"shared", "shared-pinned", "replicated"};
+    const bool replicate[] = {false, false, true};
+    const bool pin[] = {false, true, true};
+
+    bench_result_t res[3];
+    for(int i = 0; i < 3; i++)
+        res[i] = bench_config(base, topology, replicate[i], pin[i], threads, T, rounds);
+
+    printf("sparse graph with %u vertices and %u edges, %d threads, %d rounds of %lld trees\n", base.vertex_count_all(), base.edge_count_all(), threads, rounds, T);
+    for(int i = 0; i < 3; i++)
+        printf("  %-14s %10.1lf trees/s (x%.2lf), %8.3lf ms per contraction, %lld edges\n",
+            names[i], res[i].trees_per_second, res[i].trees_per_second / res[0].trees_per_second, res[i].mutation_ms, res[i].edges);
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Walk steps per second of GraphLite under each reordering, on the sparse and lattice families
+// Vertex ids are shuffled first, as for a loaded graph without any locality
+#include <graph_lite.hpp>
+#include <graph_lite_generator.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+// relabel the vertices randomly
+void shuffle_vertices(vid_t n, graph_lite_generator::edge_list_t* edges, unsigned long seed)
+{
+    std::vector<vid_t> perm(n);
+    for(vid_t v = 0; v < n; v++)
+        perm[v] = v;
+    std::shuffle(perm.begin(), perm.end(), std::mt19937_64(seed));
+
+    for(auto& e : *edges){
+        e.from = perm[e.from];
+        e.to = perm[e.to];
+    }
+}
+
+double walk_steps_per_second(GraphLite* gl, long long steps)
+{
+    std::mt19937_64 rng(1);
+    vid_t u = gl->random_connected_vertex(rng);
+
+    auto begin = std::chrono::steady_clock::now();
+    for(long long s = 0; s < steps; s++)
+        u = gl->edge_other_end(gl->random_incident_edge(u, rng), u);
+    auto end = std::chrono::steady_clock::now();
+
+    volatile vid_t end_vertex = u; // keep the walk
+    (void)end_vertex;
+    return steps / std::chrono::duration<double>(end - begin).count();
+}
+
+void bench_family(const char* family, vid_t n, const graph_lite_generator::edge_list_t& edges, long long steps)
+{
+    const char* names[] = {"none", "bfs", "rcm", "degree"};
+    const GraphLite::reorder_mode_t modes[] = {GraphLite::REORDER_NONE, GraphLite::REORDER_BFS, GraphLite::REORDER_RCM, GraphLite::REORDER_DEGREE};
+
+    double rate[4];
+    for(int i = 0; i < 4; i++){
+        GraphLite gl(n, edges, modes[i]);
+        rate[i] = walk_steps_per_second(&gl, steps);
+    }
+
+    printf("%s graph with %u vertices and %u edges, %lld walk steps\n", family, n, (eid_t)edges.size(), steps);
+    for(int i = 0; i < 4; i++)
+        printf("  %-8s %8.2lf M steps/s (x%.2lf)\n", names[i], rate[i] * 1e-6, rate[i] / rate[0]);
+    printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        printf("Usage: %s SPARSE_NUM_OF_VERTICES LATTICE_SIDE [NUM_OF_STEPS]\n", argv[0]);
+        return 1;
+    }
+
+    const vid_t N = atoi(argv[1]);
+    const vid_t side = atoi(argv[2]);
+    const long long steps = argc >= 4 ? atoll(argv[3]) : 10000000;
+
+    // average degree about 5, as the sparse graphs of main.cpp
+    auto sparse = graph_lite_generator::connected_gnp_edges(N, 3.0 / N, 123);
+    shuffle_vertices(N, &sparse, 1);
+    bench_family("sparse", N, sparse, steps);
+
+    auto lattice = graph_lite_generator::lattice_edges({side, side});
+    shuffle_vertices(side * side, &lattice, 2);
+    bench_family("lattice", side * side, lattice, steps);
+
+    return 0;
+}
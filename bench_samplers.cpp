@@ -0,0 +1,91 @@
+// Time the spanning tree engines of RandomSpanningTrees on the graph families of main.cpp,
+// and report the fastest engine for each
+#include <graph_generator.h>
+#include <graph_lite.hpp>
+#include <random_spanning_trees.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+typedef struct bench_result{
+    const char* engine;
+    double us_per_tree; // microseconds
+    double mean_path; // sanity check, should be vertex_count() - 1
+}bench_result_t;
+
+template<typename engine_t>
+bench_result_t bench_engine(GraphLite* gl, int T, unsigned long seed)
+{
+    RandomSpanningTrees rst(gl, seed);
+
+    std::vector<eid_t> path;
+    std::vector<eid_t> next(gl->vertex_count_all());
+    std::vector<bool> in_tree(gl->vertex_count_all());
+
+    long long path_total = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for(int t = 0; t < T; t++){
+        const vid_t root = gl->random_connected_vertex(rst.random_engine());
+        rst.get_st<engine_t>(&path, root, &next, &in_tree);
+        path_total += path.size();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return {engine_t::name, std::chrono::duration<double, std::micro>(end - begin).count() / T, path_total / (double)T};
+}
+
+void bench_family(const char* family, igraph_t* g, int T)
+{
+    GraphLite gl(g);
+
+    printf("%s graph with %u vertices and %u edges, %d trees per engine\n", family, gl.vertex_count_all(), gl.edge_count_all(), T);
+
+    const bench_result_t results[] = {
+        bench_engine<RandomSpanningTrees::Wilson>(&gl, T, 1),
+        bench_engine<RandomSpanningTrees::CyclePopping>(&gl, T, 2),
+        bench_engine<RandomSpanningTrees::AldousBroder>(&gl, T, 3),
+        bench_engine<RandomSpanningTrees::WilsonInterleaved>(&gl, T, 4),
+    };
+
+    const bench_result_t* best = &results[0];
+    for(const auto& r : results){
+        printf("  %-20s %10.2lf us per tree (mean tree size %.1lf)\n", r.engine, r.us_per_tree, r.mean_path);
+        if(r.us_per_tree < best->us_per_tree)
+            best = &r;
+    }
+    printf("  fastest for %s graph: %s\n\n", family, best->engine);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        printf("Usage: %s NUM_OF_VERTICES [NUM_OF_TREES]\n", argv[0]);
+        return 1;
+    }
+
+    const int N = atoi(argv[1]);
+    const int T = argc >= 3 ? atoi(argv[2]) : 1000;
+
+    srand(123);
+
+    igraph_t g;
+
+    igraph_full(&g, N, IGRAPH_UNDIRECTED, IGRAPH_NO_LOOPS);
+    bench_family("full", &g, T);
+    igraph_destroy(&g);
+
+    generate_random_connected_graph(&g, N, 0.1, 5);
+    bench_family("sparse", &g, T);
+    igraph_destroy(&g);
+
+    igraph_ring(&g, N, IGRAPH_UNDIRECTED, 0, 1);
+    bench_family("ring", &g, T);
+    igraph_destroy(&g);
+
+    return 0;
+}
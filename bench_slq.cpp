@@ -0,0 +1,70 @@
+// Stochastic Lanczos quadrature against the dense MTT log-determinant on the sparse and lattice families,
+// over a range of probe counts; MTT is only run up to a few thousand vertices
+#include <graph_lite.hpp>
+#include <graph_lite_generator.hpp>
+#include <slq_logdet.hpp>
+#include <mtt.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+const vid_t MTT_MAX_VERTICES = 4000;
+
+double mtt_logdet(GraphLite* gl)
+{
+    const vid_t n = gl->vertex_count_all();
+    Eigen::MatrixXd laplacian = Eigen::MatrixXd::Zero(n, n);
+    for(const auto& e : gl->edge_list()){
+        laplacian(e.from, e.from) += 1;
+        laplacian(e.to, e.to) += 1;
+        laplacian(e.from, e.to) -= 1;
+        laplacian(e.to, e.from) -= 1;
+    }
+    return logdet(laplacian.topLeftCorner(n-1, n-1), true);
+}
+
+void bench_family(const char* family, GraphLite* gl, int steps, int threads)
+{
+    printf("%s graph with %u vertices and %u edges, %d Lanczos steps, %d threads\n", family, gl->vertex_count_all(), gl->edge_count_all(), steps, threads);
+
+    if(gl->vertex_count_all() <= MTT_MAX_VERTICES){
+        auto begin = std::chrono::steady_clock::now();
+        const double exact = mtt_logdet(gl);
+        auto end = std::chrono::steady_clock::now();
+        printf("  MTT       e^%.6e, %8.3lf seconds\n", exact, std::chrono::duration<double>(end - begin).count());
+    }
+
+    for(int probes : {8, 32, 128}){
+        auto begin = std::chrono::steady_clock::now();
+        const auto res = SLQLogDet<GraphLite>(probes, steps, threads, 1).estimate(gl);
+        auto end = std::chrono::steady_clock::now();
+        printf("  SLQ %4d  e^%.6e +- %.2e, %8.3lf seconds, %lld mat-vecs\n",
+            probes, res.logdet, res.std_error, std::chrono::duration<double>(end - begin).count(), res.matvecs);
+    }
+    printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        printf("Usage: %s SPARSE_NUM_OF_VERTICES LATTICE_SIDE [LANCZOS_STEPS] [NUM_OF_THREADS]\n", argv[0]);
+        return 1;
+    }
+
+    const vid_t N = atoi(argv[1]);
+    const vid_t side = atoi(argv[2]);
+    const int steps = argc >= 4 ? atoi(argv[3]) : 64;
+    const int threads = argc >= 5 ? std::max(1, atoi(argv[4])) : 1;
+
+    // average degree about 5, as the sparse graphs of main.cpp
+    GraphLite sparse(N, graph_lite_generator::connected_gnp_edges(N, 3.0 / N, 123));
+    bench_family("sparse", &sparse, steps, threads);
+
+    GraphLite lattice(side * side, graph_lite_generator::lattice_edges({side, side}));
+    bench_family("lattice", &lattice, steps, threads);
+
+    return 0;
+}
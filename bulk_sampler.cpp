@@ -0,0 +1,151 @@
+// Uniform spanning trees of one graph, drawn in bulk by all threads and streamed to a file or a pipe in the
+// binary format of tree_stream.hpp; the rate is reported on stderr, as stdout may carry the stream
+#include <graph_lite.hpp>
+#include <graph_lite_generator.hpp>
+#include <bulk_tree_sampler.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifndef GRAPH_REORDER
+#define GRAPH_REORDER GraphLite::REORDER_NONE
+#endif
+
+// sparse:N and lattice:SIDE as in the benchmarks, otherwise a file of "u v" lines with 0-based vertex ids
+bool load_graph(const char* spec, vid_t* n, graph_lite_generator::edge_list_t* edges)
+{
+    if(strncmp(spec, "sparse:", 7) == 0){
+        *n = atoi(spec + 7);
+        // average degree about 5, as the sparse graphs of main.cpp
+        *edges = graph_lite_generator::connected_gnp_edges(*n, 3.0 / *n, 123);
+        return *n > 1;
+    }
+    if(strncmp(spec, "lattice:", 8) == 0){
+        const vid_t side = atoi(spec + 8);
+        *n = side * side;
+        *edges = graph_lite_generator::lattice_edges({side, side});
+        return *n > 1;
+    }
+
+    FILE* f = fopen(spec, "r");
+    if(!f)
+        return false;
+    *n = 0;
+    edges->clear();
+    unsigned long long u, v;
+    while(fscanf(f, "%llu %llu", &u, &v) == 2){
+        if(u == v) // a loop is in no spanning tree
+            continue;
+        edges->push_back({(vid_t)u, (vid_t)v});
+        *n = std::max<vid_t>(*n, std::max(u, v) + 1);
+    }
+    fclose(f);
+    return *n > 1;
+}
+
+// Every vertex must be reached, the walks of the samplers would not end otherwise
+bool connected(vid_t n, const graph_lite_generator::edge_list_t& edges)
+{
+    std::vector<vid_t> root(n);
+    for(vid_t v = 0; v < n; v++)
+        root[v] = v;
+    auto find = [&](vid_t v){
+        while(root[v] != v)
+            v = root[v] = root[root[v]];
+        return v;
+    };
+
+    vid_t components = n;
+    for(const auto& e : edges){
+        const vid_t a = find(e.from), b = find(e.to);
+        if(a != b){
+            root[a] = b;
+            components--;
+        }
+    }
+    return components == 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s GRAPH NUM_OF_TREES OUTPUT [ENCODING] [NUM_OF_THREADS] [SEED] [PER_TREE_SEEDS]\n", argv[0]);
+        fprintf(stderr, "  GRAPH     sparse:N, lattice:SIDE, or a file of \"u v\" edges\n");
+        fprintf(stderr, "  OUTPUT    file, or - for stdout\n");
+        fprintf(stderr, "  ENCODING  parent (default) or delta\n");
+        return 1;
+    }
+
+    const long long T = atoll(argv[2]);
+    const std::string output = argv[3];
+
+    BulkTreeSampler<GraphLite>::options_t opt;
+    if(argc >= 5){
+        if(strcmp(argv[4], "parent") == 0)
+            opt.encoding = tree_stream::ENCODING_PARENT;
+        else if(strcmp(argv[4], "delta") == 0)
+            opt.encoding = tree_stream::ENCODING_DELTA;
+        else{
+            fprintf(stderr, "unknown encoding %s\n", argv[4]);
+            return 1;
+        }
+    }
+    opt.num_threads = argc >= 6 ? std::max(1, atoi(argv[5])) : 1;
+    opt.seed = argc >= 7 ? strtoul(argv[6], nullptr, 10) : 1;
+    opt.per_tree_seeds = argc >= 8 ? atoi(argv[7]) != 0 : true;
+#ifdef PIN_THREADS
+    opt.pin = true;
+#endif
+
+    // the stream gets its own descriptor, and the logging of the library on stdout goes to stderr
+    FILE* out = nullptr;
+    if(output == "-"){
+        setvbuf(stdout, nullptr, _IOLBF, 0);
+        out = fdopen(dup(STDOUT_FILENO), "wb");
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+    }
+    else
+        out = fopen(output.c_str(), "wb");
+    if(!out){
+        fprintf(stderr, "cannot open %s\n", output.c_str());
+        return 1;
+    }
+    static char out_buffer[1 << 20];
+    setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    vid_t n;
+    graph_lite_generator::edge_list_t edges;
+    if(!load_graph(argv[1], &n, &edges)){
+        fprintf(stderr, "cannot load graph %s\n", argv[1]);
+        return 1;
+    }
+    if(!connected(n, edges)){
+        fprintf(stderr, "graph %s is not connected\n", argv[1]);
+        return 1;
+    }
+    GraphLite gl(n, edges, GRAPH_REORDER);
+
+    BulkTreeSampler<GraphLite> sampler(&gl, opt);
+
+    auto begin = std::chrono::steady_clock::now();
+    const long long bytes = sampler.run(T, out);
+    auto end = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+
+    if(fclose(out) != 0 || bytes < 0){
+        fprintf(stderr, "write to %s failed\n", output.c_str());
+        return 1;
+    }
+
+    fprintf(stderr, "%lld trees of %u vertices and %u edges, %s encoding, %d threads: %.3lf seconds, %.1lf trees/s, %.2lf MB/s, %.2lf bytes per tree\n",
+        T, gl.vertex_count_all(), gl.edge_count_all(), opt.encoding == tree_stream::ENCODING_PARENT ? "parent" : "delta",
+        opt.num_threads, seconds, T / seconds, bytes / seconds * 1e-6, T > 0 ? (double)(bytes - sizeof(tree_stream::header_t)) / T : 0.0);
+
+    return 0;
+}
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "graph_lite.hpp"
+#include "pivot_kernels.hpp"
+#include "random_spanning_trees.hpp"
+#include "laplacian_solver.hpp"
+#include "slq_logdet.hpp"
 
 #include <cassert>
 #include <vector>
@@ -8,11 +12,15 @@
 #include <array>
 
 #include <algorithm>
+#include <numeric>
+#include <cmath>
 
+#include <random>
+#include <functional>
 
-class RandomSpanningTrees;
 
-class ApproxCountST{
+// Settings and result of the estimator, shared by the instantiations of all index widths
+class ApproxCountSTConfig{
 
 public:
 
@@ -22,10 +30,30 @@ public:
         CONSTANT
     };
 
+    // order in which the edges become pivots, it changes the cost but not the estimator
+    // IDENTITY: original edge ids; SHUFFLE: random; DEGREE and PRESAMPLE: by the presence probability in a uniform
+    // spanning tree, estimated from the degrees of the endpoints or from a batch of trees; LOCALITY: BFS order
+    enum edge_order_t{
+        ORDER_IDENTITY = 0,
+        ORDER_SHUFFLE,
+        ORDER_DEGREE,
+        ORDER_PRESAMPLE,
+        ORDER_LOCALITY
+    };
+
+    // how the ratio of a pivot is obtained, the telescoping product is the same for both
+    // SAMPLING: frequency in uniform spanning trees drawn by the engine of approx_count_st, until convergence;
+    // RESISTANCE: effective resistance of the pivot edge, which is its probability to be in a uniform spanning tree,
+    // from one Laplacian solve of the current graph, see LaplacianSolver
+    enum ratio_engine_t{
+        ENGINE_SAMPLING = 0,
+        ENGINE_RESISTANCE
+    };
+
     enum count_mode_t{
-        UNSPECIFIED = 0,
-        PRESENCE,
-        ABSENCE
+        UNSPECIFIED = pivot_kernels::MODE_UNSPECIFIED,
+        PRESENCE = pivot_kernels::MODE_PRESENCE,
+        ABSENCE = pivot_kernels::MODE_ABSENCE
     };
 
     
@@ -34,104 +62,181 @@ public:
         double count_log = 0.0;
         long long effective_samples = 0;
         long long actual_samples = 0;
+        long long exact_tail_pivot = -1; // first pivot replaced by the exact count of the residual graph, -1 if none
+        double exact_tail_log = 0.0; // log of the exact count of the residual graph
+        long long solver_iterations = 0; // conjugate gradient iterations of ENGINE_RESISTANCE
+        // standard error of count_log, by the delta method over the sampled ratios, (1-r)/(n r) each,
+        // the correlation of rippled samples ignored; it includes the error of an SLQ tail
+        double count_log_std_error = 0.0;
+        long long forced_pivots = 0; // ratios taken before convergence, as their share of the budget ran out
+        bool budget_exhausted = false; // the pivots left were replaced by a count of the residual graph, exact or SLQ
+        long long estimated_tail_pivot = -1; // first pivot replaced by the SLQ estimate of the residual graph, -1 if none
         double epsilon; // probabilistic multiplicative error bound
         double delta; // probabilistic confidence
     }result_t;
-    
-    typedef struct pivot_stats{
-        eid_t eid = -1;
-        int total = 0;
-        int rippled_total = 0; // record keeping of how many samples we gotten from rippling
-        int present = 0;
-        int absent = 0;
-        count_mode_t count_mode = UNSPECIFIED;
-        double ratio = -1;
 
-        int update_count = 0;
-        int requested_batch_size = initial_requested_batch_size;
-        std::array<double, PIVOT_BUFFER_SIZE> inverse_ratio_buffer;
+    // Limits of one run of approx_count_st, 0 for none
+    // Each pivot gets an equal share of what is left over the valid edges left, and its ratio is taken as it stands
+    // once its share is used; if the budget still runs out, the residual graph is counted exactly when small
+    // enough, by SLQLogDet otherwise
+    typedef struct budget{
+        double seconds = 0.0; // wall clock
+        long long samples = 0; // spanning trees drawn
+        bool limited() const {return seconds > 0.0 || samples > 0;}
+    }budget_t;
+
+    // State of a run, reported after every pivot
+    typedef struct progress{
+        size_t pivot = 0; // pivots done
+        size_t pivots = 0;
+        double count_log = 0.0; // of the pivots done so far, the residual graph not counted
+        double count_log_std_error = 0.0;
+        long long samples = 0; // spanning trees drawn
+        double seconds = 0.0;
+        double budget_used = 0.0; // fraction of the budget, 0 without one
+    }progress_t;
+
+    typedef std::function<void(const progress_t&)> progress_callback_t;
+
+    // residual graphs up to this many vertices are counted exactly when the budget runs out
+    static const int BUDGET_EXACT_TAIL_VERTICES = 2000;
+
+    static convergence_mode_t convergence_mode;
+    static double convergence_ratio_threshold;
+    static double convergence_variance_threshold;
+    static int convergence_constant_threshold;
+    static int initial_requested_batch_size;
+    static edge_order_t edge_order;
+    static ratio_engine_t ratio_engine;
+    static double resistance_tolerance; // relative residual of the solves of ENGINE_RESISTANCE
+
+    // once the graph shrinks to at most this many vertices or edges, the remaining pivots are replaced by
+    // the exact log-determinant of the residual Laplacian, 0 to disable
+    static int exact_tail_vertex_threshold;
+    static int exact_tail_edge_threshold;
+};
+
+
+template<typename graph_t>
+class BasicApproxCountST : public ApproxCountSTConfig{
+
+public:
+
+    typedef typename graph_t::vid_t vid_t;
+    typedef typename graph_t::eid_t eid_t;
+    typedef BasicRandomSpanningTrees<graph_t> sampler_t;
+
+    // Statistics of all pivots, stored as struct of arrays, so that kernels could work on many pivots at once
+    typedef struct pivot_store{
+        std::vector<eid_t> eid;
+        std::vector<int> total;
+        std::vector<int> rippled_total; // record keeping of how many samples we gotten from rippling
+        std::vector<int> present;
+        std::vector<int> absent;
+        std::vector<int8_t> count_mode; // count_mode_t
+        std::vector<double> ratio;
+
+        std::vector<int> update_count;
+        std::vector<int> requested_batch_size;
+        std::vector<double> inverse_ratio_buffer; // PIVOT_BUFFER_SIZE consecutive entries per pivot
+
+        size_t size() const {return eid.size();}
+
+        void resize(size_t K){
+            eid.assign(K, graph_t::NO_EDGE);
+            total.assign(K, 0);
+            rippled_total.assign(K, 0);
+            present.assign(K, 0);
+            absent.assign(K, 0);
+            count_mode.assign(K, UNSPECIFIED);
+            ratio.assign(K, -1);
+            update_count.assign(K, 0);
+            requested_batch_size.assign(K, initial_requested_batch_size);
+            inverse_ratio_buffer.assign((size_t)K * PIVOT_BUFFER_SIZE, 0.0);
+        }
 
+        double* buffer(size_t k){return inverse_ratio_buffer.data() + (size_t)k * PIVOT_BUFFER_SIZE;}
 
-        void update(){
+        void update(size_t k){
 
             // not enough samples to create a new ratio data in the buffer
-            if (present + absent < total + requested_batch_size)
+            if (present[k] + absent[k] < total[k] + requested_batch_size[k])
                 return;
-            total = present + absent;
+            total[k] = present[k] + absent[k];
 
-            switch (count_mode){
+            switch (count_mode[k]){
                 case PRESENCE:
-                    ratio = present / (double)total;
+                    ratio[k] = present[k] / (double)total[k];
                     break;
                 case ABSENCE:
-                    ratio = absent / (double)total;
+                    ratio[k] = absent[k] / (double)total[k];
                     break;
                 default:
                     return;
             }
 
             
-            inverse_ratio_buffer[update_count % PIVOT_BUFFER_SIZE] = 1.0 / ratio;
-            update_count++;
+            buffer(k)[update_count[k] % PIVOT_BUFFER_SIZE] = 1.0 / ratio[k];
+            update_count[k]++;
         }
 
-        bool test_constant(){
-            if (total > convergence_constant_threshold)
+        bool test_constant(size_t k){
+            if (total[k] > convergence_constant_threshold)
                 return true;
             else
                 return false;
         }
 
-        bool test_converged_ratio(){
-            double rmax = *std::max_element(inverse_ratio_buffer.begin(), inverse_ratio_buffer.end());
-            double rmin = *std::min_element(inverse_ratio_buffer.begin(), inverse_ratio_buffer.end());
+        bool test_converged_ratio(size_t k){
+            double rmax, rmin;
+            pivot_kernels::buffer_minmax(buffer(k), PIVOT_BUFFER_SIZE, &rmin, &rmax);
             
             assert(rmax > 0.2);
             // printf("%lf\n", rmin);
             assert(rmin > 0.1);
 
            if (rmax / rmin < 1 + convergence_ratio_threshold){
-                printf("\nFinal Ratio = %.3lf, batch size = %d\n\n", 0.5 * (rmax + rmin), requested_batch_size);
-                ratio = 1.0 / (0.5 * (rmax + rmin));
+                printf("\nFinal Ratio = %.3lf, batch size = %d\n\n", 0.5 * (rmax + rmin), requested_batch_size[k]);
+                ratio[k] = 1.0 / (0.5 * (rmax + rmin));
                 return true;
             }
             else
                 return false;
         }
 
-        bool test_converged_variance(){
-            double sum = std::accumulate(inverse_ratio_buffer.begin(), inverse_ratio_buffer.end(), 0.0);
-            double mean = sum / inverse_ratio_buffer.size();
+        bool test_converged_variance(size_t k){
+            double sum, sq_sum;
+            pivot_kernels::buffer_moments(buffer(k), PIVOT_BUFFER_SIZE, &sum, &sq_sum);
+            double mean = sum / PIVOT_BUFFER_SIZE;
 
-            double sq_sum = std::inner_product(inverse_ratio_buffer.begin(), inverse_ratio_buffer.end(), inverse_ratio_buffer.begin(), 0.0);
-            double stddev = std::sqrt(sq_sum / inverse_ratio_buffer.size() - mean * mean);
+            double stddev = std::sqrt(sq_sum / PIVOT_BUFFER_SIZE - mean * mean);
 
             if(stddev / mean < convergence_variance_threshold){
-                ratio = 1.0 / mean;
-                printf("\nFinal Ratio = %.3lf, batch size = %d\n\n", mean, requested_batch_size);
+                ratio[k] = 1.0 / mean;
+                printf("\nFinal Ratio = %.3lf, batch size = %d\n\n", mean, requested_batch_size[k]);
                 return true;
             }
             else
                 return false;
         }
 
-        bool converged(){
-            if(count_mode == UNSPECIFIED)
+        bool converged(size_t k){
+            if(count_mode[k] == UNSPECIFIED)
                 return false;
             
             // only test convergence when the buffer is fully filled
-            if(update_count < PIVOT_BUFFER_SIZE)
+            if(update_count[k] < PIVOT_BUFFER_SIZE)
                 return false;
 
             switch (convergence_mode){ // CONVERGENCE!
                 case RATIO:
-                    if(test_converged_ratio()) return true;
+                    if(test_converged_ratio(k)) return true;
                     break;
                 case VARIANCE:
-                    if(test_converged_variance()) return true;
+                    if(test_converged_variance(k)) return true;
                     break;
                 case CONSTANT:
-                    if(test_constant()) return true;
+                    if(test_constant(k)) return true;
                     break;
                 default:
                     assert(0);
@@ -140,70 +245,91 @@ public:
             // printf("->%.3lf", rmax / rmin);
 
             // increase the sampling size, capped for 20% increase
-            requested_batch_size = std::max(requested_batch_size, total / PIVOT_BUFFER_SIZE / 10);
+            requested_batch_size[k] = std::max(requested_batch_size[k], total[k] / PIVOT_BUFFER_SIZE / 10);
             return false;
         }
 
 
         // This function should be called everytime new samples are collected, but the count_mode is still UNSPECIFIED
-        bool try_set_count_mode(){
-            if(count_mode != UNSPECIFIED)
+        bool try_set_count_mode(size_t k){
+            if(count_mode[k] != UNSPECIFIED)
                 return true;
             
-            if (total < PRESAMPLE_SIZE_REQUIRED)
+            if (total[k] < PRESAMPLE_SIZE_REQUIRED)
                 return false;
 
-            if (present / (double)total > 0.5)
-                count_mode = PRESENCE;
+            if (present[k] / (double)total[k] > 0.5)
+                count_mode[k] = PRESENCE;
             else
-                count_mode = ABSENCE;
+                count_mode[k] = ABSENCE;
 
             return true;
         }
 
-        void print(){
-            printf("total %d (%d|%d), ratio %.3lf, mode %d, update_count %d\n", total, present, absent, ratio, count_mode, update_count);
+        void print(size_t k){
+            printf("total %d (%d|%d), ratio %.3lf, mode %d, update_count %d\n", total[k], present[k], absent[k], ratio[k], count_mode[k], update_count[k]);
         }
-    }pivot_stats_t;
+    }pivot_store_t;
 
-    ApproxCountST() = delete;
-    // Initialise constants and g_contracted
-    ApproxCountST(GraphLite* g);
+    BasicApproxCountST() = delete;
+    // Initialise constants and g_contracted, the seed decides the random stream of this run
+    BasicApproxCountST(graph_t* g, unsigned long seed = std::random_device()());
 
 
-    // result stored in ps_vec
-    result_t approx_count_st();
+    // result stored in ps, the spanning trees are drawn by the given engine of SamplerEngines
+    // With a budget, the best estimate is returned when it runs out; with a progress callback, it is called after
+    // every pivot instead of printing the progress of the sampling
+    template<typename engine_t = SamplerEngines::SAMPLER_ENGINE>
+    result_t approx_count_st(const budget_t& budget = budget_t(), const progress_callback_t& on_progress = nullptr);
 
     void print_all();
 
-    std::vector<pivot_stats_t> ps_vec;
-
-    static convergence_mode_t convergence_mode;
-    static double convergence_ratio_threshold;
-    static double convergence_variance_threshold;
-    static int convergence_constant_threshold;
-    static int initial_requested_batch_size;
+    pivot_store_t ps;
     
 private:
-    inline bool check_convergence(eid_t* k);
+    inline bool check_convergence(size_t* k);
+    inline void apply_pivot(size_t k); // contract or remove the pivot edge, by its count mode
+    void force_pivot(size_t k); // ratio and count mode of pivot k from the samples so far, when out of its share of the budget
+
+    // variance of log(1/r) for a ratio r estimated from n samples, 0 for a ratio not sampled
+    static double ratio_log_variance(double r, long long n){return n > 0 ? (1.0 - r) / (n * r) : 0.0;}
+
+    // ratio and count mode of pivot k from the effective resistance of its edge in the current graph
+    void resistance_ratio(size_t k, LaplacianSolver<graph_t>* solver, long long* iterations);
+
+    void order_edges(); // fills e_order
+
+    inline bool exact_tail_reached();
+    double residual_logdet(); // log of the spanning tree count of the current graph
 
     typedef struct sampling_struct{
         std::vector<eid_t> path;
         std::vector<eid_t> next;
         std::vector<bool> in_tree;
+        std::vector<uint8_t> in_path; // indexed by edge, padded for the gathers of pivot_kernels::ripple_sample
     }sampling_struct_t;
 
-    // This routine will make n ST samples, rooted at vertex vid. It also updates ps_vec until the first unspecified entries
-    void sample_mini_batch_with_updates(RandomSpanningTrees* rst, int k_start, sampling_struct_t* sampling_struct);
+    // validity of the pivot edges, cached as the graph only changes when a pivot converges
+    std::vector<uint8_t> pivot_valid;
+    size_t pivot_valid_upto = 0; // pivot_valid is up to date below this index
+    inline void refresh_pivot_valid(size_t k_end);
+
+    // This routine will make n ST samples, rooted at vertex vid. It also updates ps until the first unspecified entries
+    template<typename engine_t>
+    void sample_mini_batch_with_updates(sampler_t* rst, size_t k_start, sampling_struct_t* sampling_struct);
 
-    GraphLite* gl;
+    graph_t* gl;
+    std::mt19937_64 rng;
     
 
     const vid_t N_initial;
 	const eid_t M_initial;
-    const int K;
+    const size_t K;
 
-    std::vector<eid_t> e_shuffle;
+    std::vector<eid_t> e_order; // original edge id of each pivot
 
     
 };
+
+typedef BasicApproxCountST<GraphLite> ApproxCountST;
+typedef BasicApproxCountST<GraphLite64> ApproxCountST64;
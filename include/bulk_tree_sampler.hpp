@@ -0,0 +1,238 @@
+#pragma once
+
+// Bulk sampling of uniform spanning trees of a fixed graph into a tree stream, see tree_stream.hpp
+// Worker threads claim chunks of tree indices and encode each chunk into a buffer of their own; finished chunks
+// are written in index order by whichever worker completes the next one, so sampling and encoding never wait on
+// the output unless the workers run a whole window of chunks ahead of it. The output only has to be appendable,
+// a pipe works as well as a file, since the header holds the tree count before any tree is drawn.
+
+#include "graph_lite.hpp"
+#include "random_spanning_trees.hpp"
+#include "numa_topology.hpp"
+#include "tree_stream.hpp"
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+
+#include <cstdio>
+#include <cassert>
+
+template<typename graph_t>
+class BulkTreeSampler{
+
+public:
+
+    typedef typename graph_t::vid_t vid_t;
+    typedef typename graph_t::eid_t eid_t;
+    typedef BasicRandomSpanningTrees<graph_t> sampler_t;
+
+    typedef struct options{
+        tree_stream::encoding_t encoding = tree_stream::ENCODING_PARENT;
+        int num_threads = 1;
+        unsigned long seed = 0;
+        // tree i only depends on (seed, i), so that the stream is the same for any number of threads,
+        // otherwise every worker draws from a stream of its own, which lets buffering engines keep their batches
+        bool per_tree_seeds = true;
+        long long chunk = 64; // trees claimed at once
+        int window = 4; // chunks per thread that may wait for the output
+        bool pin = false; // workers bound to cpus spread over the NUMA nodes
+    }options_t;
+
+    BulkTreeSampler() = delete;
+    // The graph is only read, and must be uncontracted and connected; the workers share it
+    BulkTreeSampler(graph_t* gl, const options_t& opt = options_t()) : gl(gl), opt(opt){
+        assert(gl->vertex_count() == gl->vertex_count_all() && gl->edge_count() == gl->edge_count_all());
+    }
+
+    // Write the header and T trees to out, returns the bytes written, or -1 if a write failed
+    template<typename engine_t = SamplerEngines::SAMPLER_ENGINE>
+    long long run(long long T, FILE* out);
+
+private:
+
+    typedef struct worker{
+        std::unique_ptr<sampler_t> rst;
+        std::vector<eid_t> path;
+        std::vector<eid_t> next;
+        std::vector<bool> in_tree;
+
+        // tree adjacency as linked lists, for the orientation of PARENT records
+        std::vector<eid_t> head; // first slot of every vertex
+        std::vector<eid_t> link; // next slot of the same vertex, slots 2i and 2i+1 are the two ends of edge i of the path
+        std::vector<vid_t> queue;
+        std::vector<vid_t> up; // parent of every vertex, in the ids of the graph
+        std::vector<vid_t> parent; // indexed by original vertex
+
+        std::vector<uint64_t> edges; // original edge ids of DELTA records
+        std::vector<uint8_t> buffer; // records of the current chunk
+    }worker_t;
+
+    // draw tree i and append its record to the buffer of the worker
+    template<typename engine_t>
+    void sample_tree(worker_t* wk, long long i);
+
+    // PARENT record of the path towards root
+    void orient_tree(worker_t* wk, vid_t root);
+
+    graph_t* gl;
+    const options_t opt;
+};
+
+template<typename graph_t>
+template<typename engine_t>
+long long BulkTreeSampler<graph_t>::run(long long T, FILE* out)
+{
+    tree_stream::header_t hdr;
+    hdr.encoding = opt.encoding;
+    hdr.index_bytes = sizeof(vid_t);
+    hdr.vertices = gl->vertex_count_all();
+    hdr.edges = gl->edge_count_all();
+    hdr.trees = T;
+    hdr.seed = opt.seed;
+    hdr.flags = opt.per_tree_seeds ? (uint32_t)tree_stream::FLAG_PER_TREE_SEEDS : 0;
+
+    if(fwrite(&hdr, sizeof(hdr), 1, out) != 1)
+        return -1;
+
+    const int num_threads = std::max(1, opt.num_threads);
+    const long long chunks = (T + opt.chunk - 1) / opt.chunk;
+    const long long window = (long long)std::max(1, opt.window) * num_threads;
+
+    std::atomic<long long> next_chunk(0);
+    std::mutex lock;
+    std::condition_variable written;
+    long long next_write = 0; // first chunk not yet written
+    std::map<long long, std::vector<uint8_t>> ready; // chunks done ahead of next_write
+    long long bytes = sizeof(hdr);
+    bool failed = false;
+
+    std::vector<worker_t> workers(num_threads);
+    NumaTopology topology;
+
+    auto run_worker = [&](int w){
+        worker_t& wk = workers[w];
+
+        int cpu = 0;
+        topology.spread(w, &cpu);
+        if(opt.pin)
+            NumaTopology::pin_this_thread(cpu);
+
+        std::seed_seq seq{(unsigned int)(opt.seed & 0xffffffff), (unsigned int)(opt.seed >> 32), (unsigned int)w};
+        unsigned long s[2];
+        seq.generate(s, s + 2);
+        wk.rst = std::make_unique<sampler_t>(gl, s[0] << 32 ^ s[1]);
+        wk.next.resize(gl->vertex_count_all());
+        wk.in_tree.resize(gl->vertex_count_all());
+
+        for(long long c = next_chunk++; c < chunks; c = next_chunk++){
+            {
+                // bounds the memory of chunks waiting for a slow output
+                std::unique_lock<std::mutex> guard(lock);
+                written.wait(guard, [&](){return c - next_write < window || failed;});
+                if(failed)
+                    return;
+            }
+
+            wk.buffer.clear();
+            for(long long i = c * opt.chunk; i < std::min(T, (c + 1) * opt.chunk); i++)
+                sample_tree<engine_t>(&wk, i);
+
+            std::lock_guard<std::mutex> guard(lock);
+            ready[c].swap(wk.buffer);
+            for(auto it = ready.begin(); !failed && it != ready.end() && it->first == next_write; it = ready.erase(it)){
+                if(fwrite(it->second.data(), 1, it->second.size(), out) != it->second.size())
+                    failed = true;
+                bytes += it->second.size();
+                next_write++;
+            }
+            written.notify_all();
+        }
+    };
+
+    if(num_threads == 1 && !opt.pin)
+        run_worker(0);
+    else{
+        std::vector<std::thread> pool;
+        for(int w = 0; w < num_threads; w++)
+            pool.emplace_back(run_worker, w);
+        for(auto& t : pool)
+            t.join();
+    }
+
+    if(failed || fflush(out) != 0)
+        return -1;
+    assert(next_write == chunks);
+    return bytes;
+}
+
+template<typename graph_t>
+template<typename engine_t>
+void BulkTreeSampler<graph_t>::sample_tree(worker_t* wk, long long i)
+{
+    if(opt.per_tree_seeds){
+        // the interleaved engine draws a batch per call, all but the first tree are dropped here
+        std::seed_seq seq{(unsigned int)(opt.seed & 0xffffffff), (unsigned int)(opt.seed >> 32),
+                          (unsigned int)(i & 0xffffffff), (unsigned int)(i >> 32)};
+        wk->rst->random_engine().seed(seq);
+        wk->rst->discard_buffered();
+    }
+
+    const vid_t root = gl->random_connected_vertex(wk->rst->random_engine());
+    wk->rst->template get_st<engine_t>(&wk->path, root, &wk->next, &wk->in_tree);
+    assert(wk->path.size() + 1 == gl->vertex_count_all());
+
+    if(opt.encoding == tree_stream::ENCODING_PARENT)
+        orient_tree(wk, root);
+    else{
+        wk->edges.clear();
+        for(auto e : wk->path)
+            wk->edges.push_back(gl->original_edge(e));
+        tree_stream::encode_delta(&wk->edges, &wk->buffer);
+    }
+}
+
+template<typename graph_t>
+void BulkTreeSampler<graph_t>::orient_tree(worker_t* wk, vid_t root)
+{
+    const vid_t N = gl->vertex_count_all();
+    const eid_t NONE = graph_t::NO_EDGE;
+
+    wk->head.assign(N, NONE);
+    wk->link.resize(2 * wk->path.size());
+    for(size_t k = 0; k < wk->path.size(); k++){
+        const auto& edge = gl->edge(wk->path[k]);
+        wk->link[2*k] = wk->head[edge.from];
+        wk->head[edge.from] = 2*k;
+        wk->link[2*k+1] = wk->head[edge.to];
+        wk->head[edge.to] = 2*k+1;
+    }
+
+    // breadth first from the root; the path is a tree, so the only visited neighbour of a vertex is its parent
+    wk->up.resize(N);
+    wk->up[root] = graph_t::NO_VERTEX;
+    wk->parent.resize(N);
+    wk->parent[gl->original_vertex(root)] = graph_t::NO_VERTEX;
+    wk->queue.clear();
+    wk->queue.push_back(root);
+    for(size_t q = 0; q < wk->queue.size(); q++){
+        const vid_t v = wk->queue[q];
+        for(eid_t slot = wk->head[v]; slot != NONE; slot = wk->link[slot]){
+            const auto& edge = gl->edge(wk->path[slot / 2]);
+            const vid_t u = slot % 2 ? edge.from : edge.to; // the other end of the slot of v
+            if(u == wk->up[v])
+                continue;
+            wk->up[u] = v;
+            wk->parent[gl->original_vertex(u)] = gl->original_vertex(v);
+            wk->queue.push_back(u);
+        }
+    }
+    assert(wk->queue.size() == N);
+
+    tree_stream::encode_parent(wk->parent, &wk->buffer);
+}
@@ -10,12 +10,25 @@
 
 #include <random>
 
-#define eid_t int
-#define vid_t int
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+#include "incidence_arena.hpp"
 
 // Simple and Memory Efficient Undirected Graph, to Allow Contraction and Edge Removal
-class GraphLite{
+// Templated on the unsigned vertex and edge index types: 32-bit ids keep the arrays compact, 64-bit ids allow huge graphs
+template<typename vid_type, typename eid_type>
+class BasicGraphLite{
 public:
+    typedef vid_type vid_t;
+    typedef eid_type eid_t;
+    static_assert(std::is_unsigned<vid_t>::value && std::is_unsigned<eid_t>::value, "indices must be unsigned");
+
+    // the largest value of each index type marks no vertex or no edge
+    static constexpr vid_t NO_VERTEX = (vid_t)-1;
+    static constexpr eid_t NO_EDGE = (eid_t)-1;
+
     typedef struct edge{
         vid_t from;
         vid_t to;
@@ -23,67 +36,297 @@ public:
         edge(vid_t from, vid_t to) : from(from), to(to){}
     }edge_t;
 
-    inline GraphLite(const igraph_t* g);
-
-    void clear(){edge_list_.clear(); inclist_.clear();e_removed_count = 0; v_removed_count = 0;}
+    // EAGER: contraction rewrites every edge incident to the removed vertex, and drops the edges in between
+    // LAZY: contraction only merges the two vertices in a union-find; edge endpoints are resolved on access,
+    //       incident lists are spliced on the first visit, and edges turned into self loops are dropped
+    //       when a walk draws them or in the periodic compaction
+    enum contraction_mode_t{
+        EAGER = 0,
+        LAZY
+    };
+
+    // Renumbering of vertices and edges at construction, so that walks touch nearby memory
+    // BFS: breadth first order; RCM: reverse Cuthill-McKee, bandwidth reducing; DEGREE: hubs first
+    // edges are then sorted by their endpoints in the new order, the original ids are kept for mapping back
+    enum reorder_mode_t{
+        REORDER_NONE = 0,
+        REORDER_BFS,
+        REORDER_RCM,
+        REORDER_DEGREE
+    };
+
+    // Journal of mutations, so changes could be rolled back in O(number of changes)
+    enum journal_op_t{
+        EDGE_ENDPOINTS = 0, // edge_list_[e] rewritten, old endpoints stored
+        INC_ERASE,          // e erased from inclist_[v] at pos
+        INC_SLOT,           // inclist_[v] moved away from its chunk, old slot stored in journal_slots_[pos]
+        UF_SET,             // uf_[pos][v] overwritten, old value stored in from
+        INC_REPLACE,        // inclist_[v][pos] overwritten, old entry stored in e
+        BUNDLE_OF,          // bundle_of_[e] overwritten, old value stored in pos
+        BUNDLE_ERASE,       // e erased from bundles_[v] at pos, v being the representative edge
+        BUNDLE_SLOT,        // bundles_[e] moved away from its chunk, old slot stored in journal_slots_[pos]
+        BUNDLE_MOVE,        // member list of the bundle e handed over to the bundle pos
+        MULT_BOUND          // mult_bound_[v] overwritten, old value stored in pos
+    };
+
+    typedef struct journal_entry{
+        journal_op_t op;
+        vid_t v;
+        eid_t e;
+        vid_t from;
+        vid_t to;
+        size_t pos;
+    }journal_entry_t;
+
+    typedef struct checkpoint{
+        size_t journal_size;
+        eid_t e_removed_count;
+        vid_t v_removed_count;
+        vid_t unions_since_compact;
+    }checkpoint_t;
+
+    inline BasicGraphLite(const igraph_t* g, reorder_mode_t reorder = REORDER_NONE);
+    // From a list of N vertices and the edges between them, e.g. of the generators in graph_lite_generator.hpp
+    inline BasicGraphLite(vid_t N, std::vector<edge_t> edges, reorder_mode_t reorder = REORDER_NONE);
+
+    // Mapping between the ids of the graph and the ids of the igraph structure it was built from
+    vid_t original_vertex(vid_t v){return vertex_original_.empty() ? v : vertex_original_[v];}
+    eid_t original_edge(eid_t e){return edge_original_.empty() ? e : edge_original_[e];}
+    vid_t vertex_of_original(vid_t v){return vertex_internal_.empty() ? v : vertex_internal_[v];}
+    eid_t edge_of_original(eid_t e){return edge_internal_.empty() ? e : edge_internal_[e];}
+
+    // Could only be changed before any modification
+    inline void set_contraction_mode(contraction_mode_t mode);
+    contraction_mode_t contraction_mode(){return contraction_mode_;}
+
+    // Keep parallel edges as one entry of the incident lists, a bundle, with a multiplicity (EAGER mode only)
+    // The walk draws bundles in proportion to their multiplicities, and sample_parallel_edge maps a bundle to
+    // a uniform concrete edge, so the lists only grow with the number of distinct neighbours
+    // Could only be changed before any modification
+    inline void set_collapse_parallel(bool collapse);
+    bool collapse_parallel(){return collapse_parallel_;}
+    eid_t multiplicity(eid_t rep){return collapse_parallel_ ? std::max<eid_t>(1, bundles_[rep].size()) : 1;}
+    eid_t bundle_of(eid_t e){return collapse_parallel_ ? bundle_of_[e] : e;}
+    template<typename RNG>
+    inline eid_t sample_parallel_edge(eid_t rep, RNG& rng); // uniform concrete edge of the bundle, e itself if not collapsed
+    void clear(){edge_list_.clear(); inclist_.clear(); vertex_original_.clear(); vertex_internal_.clear(); edge_original_.clear(); edge_internal_.clear();e_removed_count = 0; v_removed_count = 0; release_journal(); set_contraction_mode(EAGER); set_collapse_parallel(false);}
 
     // vertices and edges could be marked removed, hence requires more care when counting
+    // in LAZY mode, edge_count() still includes the self loops not dropped yet, until compact()
     vid_t vertex_count(){return inclist_.size() - v_removed_count;}
     vid_t vertex_count_all(){return inclist_.size();}
     eid_t edge_count(){return edge_list_.size() - e_removed_count;}
     eid_t edge_count_all(){return edge_list_.size();}
 
     // Obtain element
+    // in LAZY mode the stored endpoints could be merged vertices, use find() to get the current ones
     const auto& edge(eid_t e){return edge_list_[e];}
     inline vid_t edge_other_end(eid_t e, vid_t v1);
+    inline vid_t find(vid_t v); // the vertex v has been contracted into, v itself in EAGER mode
+    inline bool is_vertex_alive(vid_t v);
+    template<typename RNG>
+    inline eid_t random_incident_edge(vid_t u, RNG& rng); // uniform among the valid edges incident to u
     inline vid_t first_connected_vertex();
-    inline vid_t random_connected_vertex();
-    void invalidate_edge(eid_t e){edge_list_[e].from =  edge_list_[e].to = -1;}
-    bool is_edge_valid(eid_t e){assert(e>=0 && e<edge_count_all());return edge_list_[e].from >= 0 && edge_list_[e].to >= 0;}
+    template<typename RNG>
+    inline vid_t random_connected_vertex(RNG& rng);
+    // Software prefetch of what random_incident_edge and edge_other_end read, for walks interleaved on one thread
+    void prefetch_slot(vid_t v) const {__builtin_prefetch(&inclist_.slot(v));}
+    void prefetch_incident(vid_t v) const {__builtin_prefetch(inclist_[v].begin());}
+    void prefetch_edge(eid_t e) const {__builtin_prefetch(&edge_list_[e]);}
+    void invalidate_edge(eid_t e){journal_edge(e); edge_list_[e].from =  edge_list_[e].to = NO_VERTEX;}
+    bool is_edge_valid(eid_t e){
+        assert(e<edge_count_all());
+        if(edge_list_[e].from == NO_VERTEX || edge_list_[e].to == NO_VERTEX)
+            return false;
+        return contraction_mode_ == EAGER || find(edge_list_[e].from) != find(edge_list_[e].to);
+    }
 
-    // Obtain whole structures
+    // Obtain whole structures, in LAZY mode these could hold merged endpoints and self loops,
+    // with collapsed parallel edges the incident lists only hold the representative edge of each bundle
     const auto& edge_list(){return edge_list_;}
     const auto& inclist(){return inclist_;}
 
     // Modify the Graph
     inline void contract_edge(eid_t e); // return number of contracted edges other than the current one
     inline void remove_edge(eid_t e);
+    inline void compact(); // LAZY mode only: splice all lists, drop all self loops and resolve all endpoints
+
+    // Snapshot handle: start journaling all modifications, and return the point to roll back to
+    // Checkpoints could be nested, as long as they are rolled back in reverse order
+    inline checkpoint_t checkpoint();
+    inline void rollback(const checkpoint_t& cp);
+    void release_journal(){journaling_ = false; journal_.clear(); journal_.shrink_to_fit(); journal_slots_.clear(); journal_slots_.shrink_to_fit();}
+    bool is_journaling(){return journaling_;}
+    size_t journal_size(){return journal_.size();}
 
     inline void sanity_check(bool check_connected = false);
     inline void print();
 
 private:
     
-    // Memory Complexity = 2M * vid_t + 2M * eid_t + N * std::vector
+    typedef IncidenceArena<eid_t> inclist_t;
+
+    // Memory Complexity = 2M * vid_t + 2M * eid_t (rounded up to powers of two, plus reserved room) + N * slot
     std::vector<edge_t> edge_list_;
-    std::vector<std::vector<eid_t>> inclist_; // incident edges for each vertex
+    inclist_t inclist_; // incident edges for each vertex, all in one pool
     eid_t e_removed_count;
     vid_t v_removed_count;
 
+    contraction_mode_t contraction_mode_ = EAGER;
+
+    // permutations of the reordering, empty if not reordered
+    std::vector<vid_t> vertex_original_, vertex_internal_;
+    std::vector<eid_t> edge_original_, edge_internal_;
+    inline static std::vector<vid_t> vertex_order(vid_t N, const std::vector<edge_t>& edges, reorder_mode_t reorder);
+    inline void build(vid_t N, std::vector<edge_t>&& edges, reorder_mode_t reorder);
+
+    // union-find of merged vertices, only allocated in LAZY mode
+    // lists of the merged vertices are chained from their representative, until they are spliced into its list
+    enum uf_array_t{
+        UF_PARENT = 0,
+        UF_SIZE,
+        UF_PENDING_HEAD,
+        UF_PENDING_TAIL,
+        UF_PENDING_NEXT,
+        UF_ARRAY_COUNT
+    };
+    std::vector<vid_t> uf_[UF_ARRAY_COUNT];
+    vid_t unions_since_compact_ = 0;
+
+    void uf_set(uf_array_t a, vid_t v, vid_t value){
+        if(journaling_)
+            journal_.push_back({UF_SET, v, NO_EDGE, uf_[a][v], NO_VERTEX, (size_t)a});
+        uf_[a][v] = value;
+    }
+    inline void splice_pending(vid_t r);
+    inline void drop_incident(vid_t u, size_t pos);
+    inline void contract_edge_lazy(eid_t e);
+
+    // parallel edges collapsed into bundles, named by a representative edge, which is the one in the incident lists
+    // the member list of a bundle of a single edge is left empty
+    bool collapse_parallel_ = false;
+    std::vector<eid_t> bundle_of_; // representative of the bundle of each edge
+    inclist_t bundles_; // member edges of each bundle, indexed by the representative
+    std::vector<eid_t> mult_bound_; // upper bound of multiplicities incident to each vertex, for rejection sampling
+    std::vector<eid_t> neighbour_mark_; // scratch, bundle of a neighbour of the surviving vertex during contraction
+
+    void set_bundle_of(eid_t e, eid_t rep){
+        if(journaling_)
+            journal_.push_back({BUNDLE_OF, NO_VERTEX, e, NO_VERTEX, NO_VERTEX, (size_t)bundle_of_[e]});
+        bundle_of_[e] = rep;
+    }
+    void raise_mult_bound(vid_t v, eid_t m){
+        if(m <= mult_bound_[v])
+            return;
+        if(journaling_)
+            journal_.push_back({MULT_BOUND, v, NO_EDGE, NO_VERTEX, NO_VERTEX, (size_t)mult_bound_[v]});
+        mult_bound_[v] = m;
+    }
+    void replace_incident(vid_t v, size_t pos, eid_t e){
+        if(journaling_)
+            journal_.push_back({INC_REPLACE, v, inclist_[v][pos], NO_VERTEX, NO_VERTEX, pos});
+        inclist_.data(v)[pos] = e;
+    }
+    void bundle_slot(eid_t rep, const typename inclist_t::slot_t& s){journal_.push_back({BUNDLE_SLOT, NO_VERTEX, rep, NO_VERTEX, NO_VERTEX, journal_slots_.size()}); journal_slots_.push_back(s);}
+    inline void merge_bundle(eid_t into, eid_t rep);
+    inline void contract_edge_collapsed(eid_t e);
+    inline void remove_edge_collapsed(eid_t e);
+
+    bool journaling_ = false;
+    std::vector<journal_entry_t> journal_;
+    std::vector<typename inclist_t::slot_t> journal_slots_; // chunks of incident lists before they were moved
+
+    void journal_edge(eid_t e){if(journaling_) journal_.push_back({EDGE_ENDPOINTS, NO_VERTEX, e, edge_list_[e].from, edge_list_[e].to, 0});}
+    void journal_erase(vid_t v, eid_t e, size_t pos){if(journaling_) journal_.push_back({INC_ERASE, v, e, NO_VERTEX, NO_VERTEX, pos});}
+    void journal_slot(vid_t v, const typename inclist_t::slot_t& s){journal_.push_back({INC_SLOT, v, NO_EDGE, NO_VERTEX, NO_VERTEX, journal_slots_.size()}); journal_slots_.push_back(s);}
 
 };
 
-GraphLite::GraphLite(const igraph_t* g)
+template<typename vid_type, typename eid_type>
+BasicGraphLite<vid_type, eid_type>::BasicGraphLite(const igraph_t* g, reorder_mode_t reorder)
+{
+    printf("GraphLite: Building Graph from igraph structure...\n");
+    printf("V = %d, E = %d\n", igraph_vcount(g), igraph_ecount(g));
+
+    const eid_t M = igraph_ecount(g);
+
+    std::vector<edge_t> edges;
+    edges.reserve(M);
+    for(eid_t i = 0; i < M ; i++)
+        edges.emplace_back((vid_t)VECTOR(g->from)[i],(vid_t)VECTOR(g->to)[i]);
+
+    build(igraph_vcount(g), std::move(edges), reorder);
+}
+
+template<typename vid_type, typename eid_type>
+BasicGraphLite<vid_type, eid_type>::BasicGraphLite(vid_t N, std::vector<edge_t> edges, reorder_mode_t reorder)
+{
+    printf("GraphLite: Building Graph from edge list...\n");
+    printf("V = %llu, E = %llu\n", (unsigned long long)N, (unsigned long long)edges.size());
+
+    build(N, std::move(edges), reorder);
+}
+
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::build(vid_t N, std::vector<edge_t>&& edges, reorder_mode_t reorder)
 {
     clear();
 
-    printf("GraphLite: Building Graph from igraph structure...\n");
-    inclist_.resize(igraph_vcount(g));
-    edge_list_.reserve(igraph_ecount(g));
+    const eid_t M = edges.size();
 
-    printf("V = %d, E = %d\n", igraph_vcount(g), igraph_ecount(g));
+    edge_list_ = std::move(edges);
 
+    std::vector<size_t> degree(N, 0);
 
-    const eid_t M = igraph_ecount(g);
+    for(const auto& e : edge_list_){
+        assert(e.from < N && e.to < N && e.from != e.to);
+        degree[e.from]++;
+        degree[e.to]++;
+    }
 
-    for(eid_t i = 0; i < M ; i++){
+    if(reorder != REORDER_NONE){
+        printf("Reordering vertices and edges (mode %d)...\n", reorder);
+
+        vertex_original_ = vertex_order(N, edge_list_, reorder);
+        vertex_internal_.resize(N);
+        for(vid_t v = 0; v < N; v++)
+            vertex_internal_[vertex_original_[v]] = v;
+
+        std::vector<edge_t> original = std::move(edge_list_);
+        edge_list_.clear();
+
+        // edges in the order of their endpoints, so that the edges of a vertex are next to each other
+        edge_original_.resize(M);
+        for(eid_t i = 0; i < M; i++)
+            edge_original_[i] = i;
+        auto key = [&](eid_t i){
+            const vid_t a = vertex_internal_[original[i].from], b = vertex_internal_[original[i].to];
+            return std::make_pair(std::min(a, b), std::max(a, b));
+        };
+        std::stable_sort(edge_original_.begin(), edge_original_.end(), [&](eid_t i, eid_t j){return key(i) < key(j);});
+
+        edge_internal_.resize(M);
+        for(eid_t i = 0; i < M; i++){
+            const edge_t& e = original[edge_original_[i]];
+            edge_list_.emplace_back(vertex_internal_[e.from], vertex_internal_[e.to]);
+            edge_internal_[edge_original_[i]] = i;
+        }
+
+        for(vid_t v = 0; v < N; v++)
+            degree[v] = 0;
+        for(const auto& e : edge_list_){
+            degree[e.from]++;
+            degree[e.to]++;
+        }
+    }
 
-        // add edge
-        auto& e = edge_list_.emplace_back((vid_t)VECTOR(g->from)[i],(vid_t)VECTOR(g->to)[i]);
+    // all lists are sized up front, the reserved room absorbs the growth from contractions
+    inclist_.init(degree);
 
+    for(eid_t i = 0; i < M ; i++){
         // add incident edge to the two vertices
-        inclist_[e.from].push_back(edge_list_.size()-1);
-        inclist_[e.to].push_back(edge_list_.size()-1);
+        inclist_.push_back(edge_list_[i].from, i);
+        inclist_.push_back(edge_list_[i].to, i);
     }
 
     sanity_check(true);
@@ -91,51 +334,293 @@ GraphLite::GraphLite(const igraph_t* g)
     printf("Done\n");
 }
 
-inline vid_t GraphLite::edge_other_end(eid_t e, vid_t v1)
+// New order of the vertices, as original ids
+template<typename vid_type, typename eid_type>
+std::vector<vid_type> BasicGraphLite<vid_type, eid_type>::vertex_order(vid_t N, const std::vector<edge_t>& edges, reorder_mode_t reorder)
+{
+    std::vector<vid_t> order;
+    order.reserve(N);
+
+    // adjacency in compressed rows
+    std::vector<eid_t> offset(N + 1, 0);
+    for(const auto& e : edges){
+        offset[e.from + 1]++;
+        offset[e.to + 1]++;
+    }
+    for(vid_t v = 0; v < N; v++)
+        offset[v + 1] += offset[v];
+    std::vector<vid_t> adj(offset[N]);
+    {
+        std::vector<eid_t> fill(offset.begin(), offset.end() - 1);
+        for(const auto& e : edges){
+            adj[fill[e.from]++] = e.to;
+            adj[fill[e.to]++] = e.from;
+        }
+    }
+    auto degree = [&](vid_t v){return offset[v + 1] - offset[v];};
+
+    if(reorder == REORDER_DEGREE){
+        for(vid_t v = 0; v < N; v++)
+            order.push_back(v);
+        std::stable_sort(order.begin(), order.end(), [&](vid_t a, vid_t b){return degree(a) > degree(b);});
+        return order;
+    }
+
+    // BFS of every component, RCM starts each from a vertex of least degree and visits neighbours by increasing degree
+    std::vector<vid_t> starts(N);
+    for(vid_t v = 0; v < N; v++)
+        starts[v] = v;
+    if(reorder == REORDER_RCM)
+        std::stable_sort(starts.begin(), starts.end(), [&](vid_t a, vid_t b){return degree(a) < degree(b);});
+
+    std::vector<bool> visited(N, false);
+    std::vector<vid_t> neighbours;
+    for(vid_t s : starts){
+        if(visited[s])
+            continue;
+        visited[s] = true;
+        order.push_back(s);
+
+        // order itself is the queue
+        for(size_t head = order.size() - 1; head < order.size(); head++){
+            const vid_t u = order[head];
+            neighbours.clear();
+            for(eid_t i = offset[u]; i < offset[u + 1]; i++)
+                if(!visited[adj[i]]){
+                    visited[adj[i]] = true;
+                    neighbours.push_back(adj[i]);
+                }
+            if(reorder == REORDER_RCM)
+                std::stable_sort(neighbours.begin(), neighbours.end(), [&](vid_t a, vid_t b){return degree(a) < degree(b);});
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+
+    if(reorder == REORDER_RCM)
+        std::reverse(order.begin(), order.end());
+
+    assert((vid_t)order.size() == N);
+    return order;
+}
+
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::set_contraction_mode(contraction_mode_t mode)
+{
+    assert(!v_removed_count && !e_removed_count && !journaling_);
+    contraction_mode_ = mode;
+
+    const vid_t N = inclist_.size();
+    for(auto& a : uf_)
+        a.clear();
+
+    if(mode == LAZY){
+        uf_[UF_PARENT].resize(N);
+        for(vid_t v = 0; v < N; v++)
+            uf_[UF_PARENT][v] = v;
+        uf_[UF_SIZE].assign(N, 1);
+        uf_[UF_PENDING_HEAD].assign(N, NO_VERTEX);
+        uf_[UF_PENDING_TAIL].assign(N, NO_VERTEX);
+        uf_[UF_PENDING_NEXT].assign(N, NO_VERTEX);
+    }
+    unions_since_compact_ = 0;
+}
+
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::set_collapse_parallel(bool collapse)
+{
+    assert(!v_removed_count && !e_removed_count && !journaling_);
+    assert(!collapse || contraction_mode_ == EAGER);
+
+    bundle_of_.clear();
+    bundles_.clear();
+    mult_bound_.clear();
+    neighbour_mark_.clear();
+
+    collapse_parallel_ = collapse;
+    if(!collapse)
+        return;
+
+    const vid_t N = inclist_.size();
+    const eid_t M = edge_list_.size();
+
+    bundle_of_.resize(M);
+    bundles_.init(std::vector<size_t>(M, 0));
+    mult_bound_.assign(N, 1);
+    neighbour_mark_.assign(N, NO_EDGE);
+
+    //// the first edge to each neighbour becomes the representative, the rest join its bundle
+
+    for(vid_t v = 0; v < N; v++){
+        for(auto e : inclist_[v]){
+            const vid_t w = edge_other_end(e, v);
+            if(w < v)
+                continue; // already bundled from the other end
+            if(neighbour_mark_[w] == NO_EDGE){
+                neighbour_mark_[w] = e;
+                bundle_of_[e] = e;
+            }
+            else
+                merge_bundle(neighbour_mark_[w], e);
+        }
+        for(auto e : inclist_[v])
+            neighbour_mark_[edge_other_end(e, v)] = NO_EDGE;
+    }
+
+    //// only the representatives stay in the lists
+
+    for(vid_t v = 0; v < N; v++){
+        eid_t* list = inclist_.data(v);
+        size_t n = 0;
+        for(size_t i = 0; i < inclist_[v].size(); i++)
+            if(bundle_of_[list[i]] == list[i]){
+                mult_bound_[v] = std::max(mult_bound_[v], multiplicity(list[i]));
+                list[n++] = list[i];
+            }
+        inclist_.resize(v, n);
+    }
+}
+
+template<typename vid_type, typename eid_type>
+template<typename RNG>
+inline eid_type BasicGraphLite<vid_type, eid_type>::sample_parallel_edge(eid_t rep, RNG& rng)
+{
+    if(!collapse_parallel_)
+        return rep;
+
+    assert(bundle_of_[rep] == rep);
+    const auto members = bundles_[rep];
+    if(members.size() <= 1)
+        return rep;
+    return members[ std::uniform_int_distribution<size_t>(0, members.size() - 1)(rng) ];
+}
+
+// path compression, every vertex on the way is pointed to the representative
+template<typename vid_type, typename eid_type>
+inline vid_type BasicGraphLite<vid_type, eid_type>::find(vid_t v)
+{
+    if(contraction_mode_ == EAGER)
+        return v;
+
+    auto& parent = uf_[UF_PARENT];
+    vid_t r = v;
+    while(parent[r] != r)
+        r = parent[r];
+
+    while(parent[v] != r){
+        vid_t next = parent[v];
+        uf_set(UF_PARENT, v, r);
+        v = next;
+    }
+    return r;
+}
+
+template<typename vid_type, typename eid_type>
+inline bool BasicGraphLite<vid_type, eid_type>::is_vertex_alive(vid_t v)
+{
+    if(contraction_mode_ == EAGER)
+        return inclist_[v].size();
+    return uf_[UF_PARENT][v] == v && (inclist_[v].size() || uf_[UF_PENDING_HEAD][v] != NO_VERTEX);
+}
+
+template<typename vid_type, typename eid_type>
+template<typename RNG>
+inline eid_type BasicGraphLite<vid_type, eid_type>::random_incident_edge(vid_t u, RNG& rng)
+{
+    if(contraction_mode_ == EAGER){
+        const auto edges = inclist_[u]; // O(1)
+        std::uniform_int_distribution<size_t> pick(0, edges.size() - 1);
+
+        if(!collapse_parallel_ || mult_bound_[u] == 1)
+            return edges[pick(rng)];
+
+        // bundles in proportion to their multiplicities, by rejection against the bound of u
+        const eid_t bound = mult_bound_[u];
+        std::uniform_int_distribution<eid_t> accept(0, bound - 1);
+        while(true){
+            const eid_t e = edges[pick(rng)];
+            const eid_t m = multiplicity(e);
+            if(m == bound || accept(rng) < m)
+                return e;
+        }
+    }
+
+    if(uf_[UF_PENDING_HEAD][u] != NO_VERTEX)
+        splice_pending(u);
+
+    while(true){
+        const auto edges = inclist_[u];
+        assert(edges.size());
+        const size_t i = std::uniform_int_distribution<size_t>(0, edges.size() - 1)(rng);
+        const eid_t e = edges[i];
+        if(is_edge_valid(e))
+            return e;
+
+        // a self loop left by contraction, drop it and draw again
+        drop_incident(u, i);
+    }
+}
+
+template<typename vid_type, typename eid_type>
+inline vid_type BasicGraphLite<vid_type, eid_type>::edge_other_end(eid_t e, vid_t v1)
 {
     assert(is_edge_valid(e));
-    if (edge_list_[e].from == v1)
-        return edge_list_[e].to;
-    else if (edge_list_[e].to == v1)
-        return edge_list_[e].from;
+    const vid_t from = find(edge_list_[e].from);
+    const vid_t to = find(edge_list_[e].to);
+    if (from == v1)
+        return to;
+    else if (to == v1)
+        return from;
     else{
-        printf("Wrong edge %d for vertex %d\n", e, v1);
+        printf("Wrong edge %llu for vertex %llu\n", (unsigned long long)e, (unsigned long long)v1);
         print();
         abort();
     }
         
 }
 
-vid_t GraphLite::first_connected_vertex()
+template<typename vid_type, typename eid_type>
+vid_type BasicGraphLite<vid_type, eid_type>::first_connected_vertex()
 {
     vid_t v = 0;
 
-    while(!inclist_[v].size()){
+    while(!is_vertex_alive(v)){
         v++;
         assert(v < vertex_count_all());
     }
     return v;
 }
 
-vid_t GraphLite::random_connected_vertex()
+template<typename vid_type, typename eid_type>
+template<typename RNG>
+vid_type BasicGraphLite<vid_type, eid_type>::random_connected_vertex(RNG& rng)
 {
     vid_t v;
 
-    std::mt19937 mt_rand(time(0));
+    std::uniform_int_distribution<vid_t> uniform(0, vertex_count_all() - 1);
 
     while(true){
-        v = mt_rand() %  vertex_count_all();
-        if (inclist_[v].size())
+        v = uniform(rng);
+        if (is_vertex_alive(v))
             break;
     }
     return v;
 }
 
 
-void GraphLite::contract_edge(eid_t e_in)
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::contract_edge(eid_t e_in)
 {
-    std::vector<eid_t> ret;
-    assert(e_in < edge_count_all() && e_in >= 0);
+    assert(e_in < edge_count_all());
+
+    if(contraction_mode_ == LAZY){
+        contract_edge_lazy(e_in);
+        return;
+    }
+
+    if(collapse_parallel_){
+        contract_edge_collapsed(e_in);
+        return;
+    }
 
     vid_t from = edge_list_[e_in].from;
     vid_t to = edge_list_[e_in].to;
@@ -145,83 +630,512 @@ void GraphLite::contract_edge(eid_t e_in)
     if (inclist_[from].size() > inclist_[to].size() )
         std::swap(from,to);
 
-    //// redirect all edges, remove all edges connect between the two
+    const size_t from_size = inclist_[from].size();
+    const size_t to_size = inclist_[to].size();
+
+    //// make room for the whole list of the removed vertex, moving the surviving list at most once
+    // when journaling, the list is always moved, so the old chunk stays intact for rollback
+
+    if(journaling_)
+        journal_slot(from, inclist_.relocate(from, from_size + to_size, false));
+    else
+        inclist_.reserve(from, from_size + to_size);
+
+    //// splice the list of the removed vertex to the end, by a single copy
+
+    eid_t* list = inclist_.data(from);
+    std::memcpy(list + from_size, inclist_.data(to), to_size * sizeof(eid_t));
+    inclist_.resize(from, from_size + to_size);
+
+    //// redirect all spliced edges, remove all edges connect between the two
 
     vid_t edge_removed = 0;
 
-    for (size_t i = 0; i < inclist_[to].size();){
+    for (size_t i = from_size; i < from_size + to_size; i++){
         
-        eid_t e = inclist_[to][i];
+        eid_t e = list[i];
 
         // assert no self loops, or wrong edge pointed
         assert(is_edge_valid(e));
         assert( (edge_list_[e].from == to) != (edge_list_[e].to == to) );
 
         if(edge_list_[e].from == from || edge_list_[e].to == from){
-            remove_edge(e);
+            invalidate_edge(e);
+            e_removed_count++;
             edge_removed++;
             continue;
         }
 
-        if(edge_list_[e].from == to){
+        journal_edge(e);
+        if(edge_list_[e].from == to)
             edge_list_[e].from = from;
-            inclist_[from].push_back(e);
-        }
-        else if (edge_list_[e].to == to){
+        else
             edge_list_[e].to = from;
-            inclist_[from].push_back(e);
+    }
+
+    //// drop the invalidated edges from both halves of the list in one pass
+
+    size_t n = 0;
+    for (size_t i = 0; i < from_size + to_size; i++)
+        if(is_edge_valid(list[i]))
+            list[n++] = list[i];
+    inclist_.resize(from, n);
+
+    //// remove one of the vertex
+    if(journaling_)
+        journal_slot(to, inclist_.detach(to, false));
+    else
+        inclist_.detach(to);
+    v_removed_count++;
+
+    printf("Contracted edge %llu and removed vertex %llu and additional %lld edges \n", (unsigned long long)e_in, (unsigned long long)to, (long long)edge_removed - 1);
+}
+
+// union by size, the lists are left as they are, so the cost does not depend on the degrees
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::contract_edge_lazy(eid_t e_in)
+{
+    assert(is_edge_valid(e_in));
+
+    vid_t r = find(edge_list_[e_in].from);
+    vid_t c = find(edge_list_[e_in].to);
+
+    if(uf_[UF_SIZE][r] < uf_[UF_SIZE][c])
+        std::swap(r, c);
+
+    uf_set(UF_PARENT, c, r);
+    uf_set(UF_SIZE, r, uf_[UF_SIZE][r] + uf_[UF_SIZE][c]);
+
+    //// chain c and everything pending on c in front of the pending lists of r
+
+    const vid_t c_head = uf_[UF_PENDING_HEAD][c];
+    const vid_t c_tail = c_head != NO_VERTEX ? uf_[UF_PENDING_TAIL][c] : c;
+
+    if(c_head != NO_VERTEX){
+        uf_set(UF_PENDING_NEXT, c, c_head);
+        uf_set(UF_PENDING_HEAD, c, NO_VERTEX);
+    }
+    uf_set(UF_PENDING_NEXT, c_tail, uf_[UF_PENDING_HEAD][r]);
+    if(uf_[UF_PENDING_HEAD][r] == NO_VERTEX)
+        uf_set(UF_PENDING_TAIL, r, c_tail);
+    uf_set(UF_PENDING_HEAD, r, c);
+
+    v_removed_count++;
+
+    printf("Contracted edge %llu and merged vertex %llu into %llu\n", (unsigned long long)e_in, (unsigned long long)c, (unsigned long long)r);
+
+    // resolving everything once in a while keeps the lists and the union-find paths short
+    if(++unions_since_compact_ > vertex_count() / 2)
+        compact();
+}
+
+// append the lists of all pending merged vertices to the list of r
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::splice_pending(vid_t r)
+{
+    assert(contraction_mode_ == LAZY && uf_[UF_PARENT][r] == r);
+
+    size_t total = inclist_[r].size();
+    for(vid_t c = uf_[UF_PENDING_HEAD][r]; c != NO_VERTEX; c = uf_[UF_PENDING_NEXT][c])
+        total += inclist_[c].size();
+
+    if(journaling_)
+        journal_slot(r, inclist_.relocate(r, total, false));
+    else
+        inclist_.reserve(r, total);
+
+    size_t n = inclist_[r].size();
+    for(vid_t c = uf_[UF_PENDING_HEAD][r]; c != NO_VERTEX; c = uf_[UF_PENDING_NEXT][c]){
+        const size_t size = inclist_[c].size();
+        std::memcpy(inclist_.data(r) + n, inclist_.data(c), size * sizeof(eid_t));
+        n += size;
+
+        if(journaling_)
+            journal_slot(c, inclist_.detach(c, false));
+        else
+            inclist_.detach(c);
+    }
+    inclist_.resize(r, n);
+
+    uf_set(UF_PENDING_HEAD, r, NO_VERTEX);
+}
+
+// drop an entry of an edge that is no longer valid, the edge is counted removed when first seen
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::drop_incident(vid_t u, size_t pos)
+{
+    const eid_t e = inclist_[u][pos];
+    assert(!is_edge_valid(e));
+
+    if(edge_list_[e].from != NO_VERTEX){
+        invalidate_edge(e);
+        e_removed_count++;
+    }
+
+    journal_erase(u, e, pos);
+    inclist_.erase(u, pos);
+}
+
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::compact()
+{
+    if(contraction_mode_ != LAZY)
+        return;
+
+    const vid_t N = inclist_.size();
+    for(vid_t v = 0; v < N; v++){
+        if(uf_[UF_PARENT][v] != v)
+            continue;
+
+        if(uf_[UF_PENDING_HEAD][v] != NO_VERTEX)
+            splice_pending(v);
+
+        // the list is about to be rewritten in place, keep the old chunk for rollback
+        if(journaling_){
+            bool dirty = false;
+            for(auto e : inclist_[v])
+                if(!is_edge_valid(e) || uf_[UF_PARENT][edge_list_[e].from] != edge_list_[e].from || uf_[UF_PARENT][edge_list_[e].to] != edge_list_[e].to){
+                    dirty = true;
+                    break;
+                }
+            if(dirty)
+                journal_slot(v, inclist_.relocate(v, inclist_[v].size(), false));
         }
-        else{
-            printf("Impossible case\n");
-            abort();
+
+        eid_t* list = inclist_.data(v);
+        size_t n = 0;
+        for(size_t i = 0; i < inclist_[v].size(); i++){
+            const eid_t e = list[i];
+            if(!is_edge_valid(e)){
+                if(edge_list_[e].from != NO_VERTEX){
+                    invalidate_edge(e);
+                    e_removed_count++;
+                }
+                continue;
+            }
+
+            const vid_t from = find(edge_list_[e].from);
+            const vid_t to = find(edge_list_[e].to);
+            if(from != edge_list_[e].from || to != edge_list_[e].to){
+                journal_edge(e);
+                edge_list_[e].from = from;
+                edge_list_[e].to = to;
+            }
+            list[n++] = e;
         }
-        i++;
+        inclist_.resize(v, n);
     }
 
-    //// remove one of the vertex
-    inclist_[to].clear();
+    unions_since_compact_ = 0;
+}
+
+// append all member edges of the bundle rep to the bundle into, both already joining the same two vertices
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::merge_bundle(eid_t into, eid_t rep)
+{
+    const size_t into_size = bundles_[into].size();
+    const size_t rep_size = bundles_[rep].size();
+    const size_t total = std::max<size_t>(1, into_size) + std::max<size_t>(1, rep_size);
+
+    if(journaling_)
+        bundle_slot(into, bundles_.relocate(into, total, false));
+    else
+        bundles_.reserve(into, total);
+
+    // a bundle of a single edge has no member list yet
+    if(!into_size)
+        bundles_.push_back(into, into);
+
+    if(!rep_size){
+        bundles_.push_back(into, rep);
+        set_bundle_of(rep, into);
+        return;
+    }
+
+    for(size_t i = 0; i < rep_size; i++){
+        const eid_t m = bundles_[rep][i];
+        bundles_.push_back(into, m);
+        set_bundle_of(m, into);
+    }
+
+    if(journaling_)
+        bundle_slot(rep, bundles_.detach(rep, false));
+    else
+        bundles_.detach(rep);
+}
+
+// Same as the EAGER contraction, but a redirected bundle is merged into the bundle the surviving vertex
+// already has to the same neighbour, if any, instead of adding a parallel entry
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::contract_edge_collapsed(eid_t e_in)
+{
+    vid_t from = edge_list_[e_in].from;
+    vid_t to = edge_list_[e_in].to;
+
+    if (inclist_[from].size() > inclist_[to].size() )
+        std::swap(from,to);
+
+    const size_t from_size = inclist_[from].size();
+    const size_t to_size = inclist_[to].size();
+
+    if(journaling_)
+        journal_slot(from, inclist_.relocate(from, from_size + to_size, false));
+    else
+        inclist_.reserve(from, from_size + to_size);
+
+    for(auto r : inclist_[from])
+        neighbour_mark_[edge_other_end(r, from)] = r;
+
+    eid_t edge_removed = 0;
+    size_t n = from_size;
+
+    for (size_t i = 0; i < to_size; i++){
+
+        const eid_t r = inclist_[to][i];
+        const vid_t w = edge_other_end(r, to);
+        const eid_t m = multiplicity(r);
+
+        //// the bundle in between turns into self loops
+        if(w == from){
+            if(m == 1)
+                invalidate_edge(r);
+            else
+                for(auto x : bundles_[r])
+                    invalidate_edge(x);
+            e_removed_count += m;
+            edge_removed += m;
+            continue;
+        }
+
+        //// redirect every member edge
+        auto redirect = [&](eid_t x){
+            journal_edge(x);
+            if(edge_list_[x].from == to)
+                edge_list_[x].from = from;
+            else
+                edge_list_[x].to = from;
+        };
+        if(m == 1)
+            redirect(r);
+        else
+            for(auto x : bundles_[r])
+                redirect(x);
+
+        const eid_t q = neighbour_mark_[w];
+        if(q == NO_EDGE){
+            inclist_.data(from)[n++] = r;
+            raise_mult_bound(from, m);
+            continue;
+        }
+
+        //// merge into the existing bundle to w, which then appears once in the list of w
+        merge_bundle(q, r);
+
+        auto list = inclist_[w];
+        const size_t pos = std::find(list.begin(), list.end(), r) - list.begin();
+        assert(pos < list.size());
+        journal_erase(w, r, pos);
+        inclist_.erase(w, pos);
+
+        raise_mult_bound(from, multiplicity(q));
+        raise_mult_bound(w, multiplicity(q));
+    }
+    inclist_.resize(from, n);
+
+    //// drop the bundle to the removed vertex, and reset the marks
+
+    eid_t* list = inclist_.data(from);
+    for (size_t i = 0; i < from_size; i++)
+        neighbour_mark_[is_edge_valid(list[i]) ? edge_other_end(list[i], from) : to] = NO_EDGE;
+
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++)
+        if(is_edge_valid(list[i]))
+            list[k++] = list[i];
+    inclist_.resize(from, k);
+
+    if(journaling_)
+        journal_slot(to, inclist_.detach(to, false));
+    else
+        inclist_.detach(to);
     v_removed_count++;
 
-    printf("Contracted edge %d and removed vertex %d and additional %d edges \n", e_in, to, edge_removed-1);
+    printf("Contracted edge %llu and removed vertex %llu and additional %lld edges \n", (unsigned long long)e_in, (unsigned long long)to, (long long)edge_removed - 1);
+}
+
+// a single member leaves its bundle, the bundle keeps its entries in the lists unless it becomes empty
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::remove_edge_collapsed(eid_t e)
+{
+    const eid_t r = bundle_of_[e];
+    const vid_t from = edge_list_[e].from;
+    const vid_t to = edge_list_[e].to;
+
+    invalidate_edge(e);
+    e_removed_count++;
+
+    if(multiplicity(r) == 1){
+        for(vid_t v : {from, to}){
+            auto list = inclist_[v];
+            auto iter = std::find(list.begin(), list.end(), e);
+            assert(iter != list.end());
+            journal_erase(v, e, iter - list.begin());
+            inclist_.erase(v, iter - list.begin());
+        }
+        printf("Removed edge %llu\n", (unsigned long long)e);
+        return;
+    }
+
+    auto members = bundles_[r];
+    const size_t pos = std::find(members.begin(), members.end(), e) - members.begin();
+    assert(pos < members.size());
+    if(journaling_)
+        journal_.push_back({BUNDLE_ERASE, (vid_t)r, e, NO_VERTEX, NO_VERTEX, pos});
+    bundles_.erase(r, pos);
+
+    //// the representative left, hand the bundle over to another member
+    if(e == r){
+        const eid_t r_new = bundles_[r][0];
+
+        if(journaling_)
+            journal_.push_back({BUNDLE_MOVE, NO_VERTEX, r, NO_VERTEX, NO_VERTEX, (size_t)r_new});
+        bundles_.move_slot(r, r_new);
+
+        for(auto x : bundles_[r_new])
+            set_bundle_of(x, r_new);
+
+        for(vid_t v : {from, to}){
+            auto list = inclist_[v];
+            auto iter = std::find(list.begin(), list.end(), r);
+            assert(iter != list.end());
+            replace_incident(v, iter - list.begin(), r_new);
+        }
+    }
+
+    printf("Removed edge %llu from bundle %llu\n", (unsigned long long)e, (unsigned long long)r);
 }
 
 // remove edge only remove from the inclist, not the edge_list, to conserve the edge id
-void GraphLite::remove_edge(eid_t e)
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::remove_edge(eid_t e)
 {
-    assert(e < edge_count_all() && e >= 0);
+    assert(e < edge_count_all());
+
+    if(collapse_parallel_){
+        remove_edge_collapsed(e);
+        return;
+    }
 
-    vid_t from = edge_list_[e].from;
-    vid_t to = edge_list_[e].to;
+    vid_t from = find(edge_list_[e].from);
+    vid_t to = find(edge_list_[e].to);
+
+    if(contraction_mode_ == LAZY){
+        assert(from != to);
+        for(vid_t v : {from, to})
+            if(uf_[UF_PENDING_HEAD][v] != NO_VERTEX)
+                splice_pending(v);
+    }
 
     // invalidate
     invalidate_edge(e);
 
 
-    auto iter = std::find(inclist_[from].begin(),inclist_[from].end(), e);
-    assert(iter != inclist_[from].end());
-    inclist_[from].erase(iter);
-
-    iter = std::find(inclist_[to].begin(),inclist_[to].end(), e);
-    assert(iter != inclist_[to].end());
-    inclist_[to].erase(iter);
+    for(vid_t v : {from, to}){
+        auto list = inclist_[v];
+        auto iter = std::find(list.begin(), list.end(), e);
+        assert(iter != list.end());
+        journal_erase(v, e, iter - list.begin());
+        inclist_.erase(v, iter - list.begin());
+    }
 
     e_removed_count++;
-    printf("Removed edge %d\n", e);
+    printf("Removed edge %llu\n", (unsigned long long)e);
+}
+
+template<typename vid_type, typename eid_type>
+typename BasicGraphLite<vid_type, eid_type>::checkpoint_t BasicGraphLite<vid_type, eid_type>::checkpoint()
+{
+    journaling_ = true;
+    return {journal_.size(), e_removed_count, v_removed_count, unions_since_compact_};
 }
 
+// undo the journal in reverse order, until reaching the checkpoint
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::rollback(const checkpoint_t& cp)
+{
+    assert(journaling_);
+    assert(cp.journal_size <= journal_.size());
+
+    while(journal_.size() > cp.journal_size){
+        const auto& j = journal_.back();
+        switch(j.op){
+            case EDGE_ENDPOINTS:
+                edge_list_[j.e].from = j.from;
+                edge_list_[j.e].to = j.to;
+                break;
+            case INC_ERASE:
+                inclist_.unerase(j.v, j.pos, j.e);
+                break;
+            case INC_SLOT:
+                // chunks taken after the checkpoint are given back to the arena
+                assert(j.pos == journal_slots_.size() - 1);
+                inclist_.set_slot(j.v, journal_slots_.back());
+                journal_slots_.pop_back();
+                break;
+            case UF_SET:
+                uf_[j.pos][j.v] = j.from;
+                break;
+            case INC_REPLACE:
+                inclist_.data(j.v)[j.pos] = j.e;
+                break;
+            case BUNDLE_OF:
+                bundle_of_[j.e] = j.pos;
+                break;
+            case BUNDLE_ERASE:
+                bundles_.unerase(j.v, j.pos, j.e);
+                break;
+            case BUNDLE_MOVE:
+                bundles_.move_slot(j.pos, j.e);
+                break;
+            case BUNDLE_SLOT:
+                assert(j.pos == journal_slots_.size() - 1);
+                bundles_.set_slot(j.e, journal_slots_.back());
+                journal_slots_.pop_back();
+                break;
+            case MULT_BOUND:
+                mult_bound_[j.v] = j.pos;
+                break;
+            default:
+                assert(0);
+        }
+        journal_.pop_back();
+    }
+
+    e_removed_count = cp.e_removed_count;
+    v_removed_count = cp.v_removed_count;
+    unions_since_compact_ = cp.unions_since_compact;
+}
 
-void GraphLite::sanity_check(bool check_connected)
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::sanity_check(bool check_connected)
 {
+    // lists are only consistent with the counts once everything is resolved
+    compact();
 
     eid_t ecount_dir = 0;
     vid_t v_removed = 0;
-    for(auto& e : inclist_){
+    for(size_t v = 0; v < inclist_.size(); v++){
+        auto e = inclist_[v];
         if(check_connected)
             assert(e.size()); // should always have incident edge(s)
         else if(!e.size())
             v_removed++;
 
-        ecount_dir += e.size();
+        if(collapse_parallel_)
+            for(auto r : e)
+                ecount_dir += multiplicity(r);
+        else
+            ecount_dir += e.size();
     }
 
     // must have pairs of incident entries
@@ -233,19 +1147,27 @@ void GraphLite::sanity_check(bool check_connected)
     assert(v_removed == v_removed_count);
 }
 
-void GraphLite::print()
+template<typename vid_type, typename eid_type>
+void BasicGraphLite<vid_type, eid_type>::print()
 {
     printf("incident list:\n");
     for(size_t i = 0; i < inclist_.size(); i++){
         printf("%3d: ", (int)i);
         for(auto e : inclist_[i])
-            printf("%3d ", e);
+            printf("%3llu ", (unsigned long long)e);
         printf("\n");
     }
 
     printf("edge list:\n");
 
     for(size_t i = 0; i < edge_list_.size(); i++)
-        printf("%3d: %3d, %3d\n", int(i), edge_list_[i].from, edge_list_[i].to);
+        printf("%3d: %3lld, %3lld\n", int(i), (long long)std::make_signed_t<vid_t>(edge_list_[i].from), (long long)std::make_signed_t<vid_t>(edge_list_[i].to));
     printf("\n");
-}
\ No newline at end of file
+}
+
+typedef BasicGraphLite<uint32_t, uint32_t> GraphLite; // up to 2^32-1 vertices and edges
+typedef BasicGraphLite<uint64_t, uint64_t> GraphLite64;
+
+// index types of the default GraphLite
+typedef GraphLite::vid_t vid_t;
+typedef GraphLite::eid_t eid_t;
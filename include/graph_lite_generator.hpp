@@ -0,0 +1,253 @@
+#pragma once
+
+// Generators building GraphLite directly, in expected O(N+M) time, unlike the igraph based ones of graph_generator.h
+// Random generators are split in a fixed number of chunks, each with its own stream seeded from (seed, chunk),
+// so that the graph only depends on the seed, regardless of the number of threads
+// GraphLite does not allow self loops or isolated vertices: all generators leave out self loops,
+// and only the connected variant guarantees that every vertex has an edge
+
+#include "graph_lite.hpp"
+
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <unordered_set>
+#include <functional>
+
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+
+namespace graph_lite_generator{
+
+typedef std::vector<GraphLite::edge_t> edge_list_t;
+
+const int CHUNKS = 64;
+
+inline std::mt19937_64 chunk_rng(unsigned long seed, int chunk)
+{
+    std::seed_seq seq{(unsigned int)(seed & 0xffffffff), (unsigned int)(seed >> 32), (unsigned int)chunk};
+    return std::mt19937_64(seq);
+}
+
+// Run make_chunk(c, &edges of chunk c) for all chunks on num_threads threads, and concatenate in chunk order
+inline edge_list_t run_chunks(int chunks, int num_threads, const std::function<void(int, edge_list_t*)>& make_chunk)
+{
+    std::vector<edge_list_t> parts(chunks);
+    std::atomic<int> next_chunk(0);
+
+    auto worker = [&](){
+        for(int c = next_chunk++; c < chunks; c = next_chunk++)
+            make_chunk(c, &parts[c]);
+    };
+
+    if(num_threads <= 1)
+        worker();
+    else{
+        std::vector<std::thread> pool;
+        for(int t = 0; t < num_threads; t++)
+            pool.emplace_back(worker);
+        for(auto& t : pool)
+            t.join();
+    }
+
+    size_t total = 0;
+    for(auto& p : parts)
+        total += p.size();
+
+    edge_list_t edges;
+    edges.reserve(total);
+    for(auto& p : parts){
+        edges.insert(edges.end(), p.begin(), p.end());
+        edge_list_t().swap(p);
+    }
+    return edges;
+}
+
+// G(n,p): every pair independently with probability p, skipping geometrically distributed gaps between the chosen pairs
+inline edge_list_t gnp_edges(vid_t n, double p, unsigned long seed, int num_threads = 1)
+{
+    if(n < 2 || p <= 0.0)
+        return edge_list_t();
+
+    // rows of the upper triangle split in chunks of about the same number of pairs
+    const double pairs = 0.5 * n * (n - 1.0);
+    std::vector<vid_t> row_begin(CHUNKS + 1, n - 1);
+    row_begin[0] = 0;
+    {
+        double cumulative = 0.0;
+        int c = 1;
+        for(vid_t v = 0; v < n - 1 && c < CHUNKS; v++){
+            cumulative += n - 1 - v;
+            while(c < CHUNKS && cumulative >= pairs * c / CHUNKS)
+                row_begin[c++] = v + 1;
+        }
+    }
+
+    const double log_q = p < 1.0 ? std::log(1.0 - p) : 0.0;
+
+    return run_chunks(CHUNKS, num_threads, [&](int c, edge_list_t* edges){
+        auto rng = chunk_rng(seed, c);
+        std::uniform_real_distribution<double> unif(0.0, 1.0);
+
+        const vid_t row_end = row_begin[c + 1];
+        edges->reserve((size_t)(p * pairs / CHUNKS * 1.1) + 16);
+
+        // (v, w) walks the pairs w > v of the rows of the chunk
+        long long v = row_begin[c], w = v;
+        while(v < row_end){
+            const long long skip = p < 1.0 ? (long long)std::floor(std::log(1.0 - unif(rng)) / log_q) : 0;
+            w += 1 + skip;
+            while(v < row_end && w >= n){
+                w = w - n + v + 2; // the first pair of row v+1 is (v+1, v+2)
+                v++;
+            }
+            if(v < row_end)
+                edges->emplace_back((vid_t)v, (vid_t)w);
+        }
+    });
+}
+
+// Uniform random spanning tree of the complete graph, from a uniform Pruefer sequence decoded in O(n)
+inline edge_list_t random_tree_edges(vid_t n, unsigned long seed)
+{
+    edge_list_t edges;
+    if(n < 2)
+        return edges;
+    edges.reserve(n - 1);
+
+    auto rng = chunk_rng(seed, CHUNKS);
+    std::uniform_int_distribution<vid_t> pick(0, n - 1);
+
+    std::vector<vid_t> code(n - 2);
+    std::vector<vid_t> degree(n, 1);
+    for(auto& x : code){
+        x = pick(rng);
+        degree[x]++;
+    }
+
+    vid_t ptr = 0;
+    while(degree[ptr] != 1)
+        ptr++;
+    vid_t leaf = ptr;
+
+    for(auto v : code){
+        edges.emplace_back(leaf, v);
+        if(--degree[v] == 1 && v < ptr)
+            leaf = v;
+        else{
+            do{
+                ptr++;
+            }while(degree[ptr] != 1);
+            leaf = ptr;
+        }
+    }
+    edges.emplace_back(leaf, n - 1);
+
+    return edges;
+}
+
+// Random d-regular multigraph of the configuration model: n*d stubs paired uniformly at random
+// Self loops are always dropped, parallel edges too if erase_parallel, so a few vertices may end with degree below d
+inline edge_list_t regular_edges(vid_t n, int d, unsigned long seed, bool erase_parallel = true)
+{
+    assert(((long long)n * d) % 2 == 0);
+
+    std::vector<vid_t> stubs((size_t)n * d);
+    for(size_t i = 0; i < stubs.size(); i++)
+        stubs[i] = i / d;
+
+    auto rng = chunk_rng(seed, 0);
+    std::shuffle(stubs.begin(), stubs.end(), rng);
+
+    edge_list_t edges;
+    edges.reserve(stubs.size() / 2);
+
+    std::unordered_set<uint64_t> seen;
+    if(erase_parallel)
+        seen.reserve(stubs.size() / 2);
+
+    for(size_t i = 0; i + 1 < stubs.size(); i += 2){
+        const vid_t a = std::min(stubs[i], stubs[i+1]), b = std::max(stubs[i], stubs[i+1]);
+        if(a == b)
+            continue;
+        if(erase_parallel && !seen.insert((uint64_t)a * n + b).second)
+            continue;
+        edges.emplace_back(a, b);
+    }
+    return edges;
+}
+
+// Grid with the given side lengths, vertex ids in row major order; periodic wraps around sides longer than 2
+inline edge_list_t lattice_edges(const std::vector<vid_t>& dims, bool periodic = false, int num_threads = 1)
+{
+    long long n = 1;
+    for(auto s : dims){
+        assert(s > 0);
+        n *= s;
+    }
+
+    return run_chunks(CHUNKS, num_threads, [&](int c, edge_list_t* edges){
+        const long long begin = n * c / CHUNKS, end = n * (c + 1) / CHUNKS;
+        edges->reserve((end - begin) * dims.size());
+
+        for(long long v = begin; v < end; v++){
+            long long stride = 1, rest = v;
+            // last dimension varies fastest
+            for(int k = (int)dims.size() - 1; k >= 0; k--){
+                const long long x = rest % dims[k];
+                rest /= dims[k];
+                if(x + 1 < dims[k])
+                    edges->emplace_back((vid_t)v, (vid_t)(v + stride));
+                else if(periodic && dims[k] > 2)
+                    edges->emplace_back((vid_t)v, (vid_t)(v - x * stride));
+                stride *= dims[k];
+            }
+        }
+    });
+}
+
+// Uniform random spanning tree first, then the pairs of G(n,p) not already in it, so the graph is always connected
+inline edge_list_t connected_gnp_edges(vid_t n, double p, unsigned long seed, int num_threads = 1)
+{
+    edge_list_t edges = random_tree_edges(n, seed);
+
+    std::unordered_set<uint64_t> tree;
+    tree.reserve(edges.size());
+    for(const auto& e : edges)
+        tree.insert((uint64_t)std::min(e.from, e.to) * n + std::max(e.from, e.to));
+
+    for(const auto& e : gnp_edges(n, p, seed, num_threads))
+        if(!tree.count((uint64_t)e.from * n + e.to))
+            edges.push_back(e);
+
+    return edges;
+}
+
+}
+
+// GraphLite of the generators above
+
+inline GraphLite generate_gnp_lite(vid_t n, double p, unsigned long seed, int num_threads = 1, GraphLite::reorder_mode_t reorder = GraphLite::REORDER_NONE)
+{
+    return GraphLite(n, graph_lite_generator::gnp_edges(n, p, seed, num_threads), reorder);
+}
+
+inline GraphLite generate_connected_gnp_lite(vid_t n, double p, unsigned long seed, int num_threads = 1, GraphLite::reorder_mode_t reorder = GraphLite::REORDER_NONE)
+{
+    return GraphLite(n, graph_lite_generator::connected_gnp_edges(n, p, seed, num_threads), reorder);
+}
+
+inline GraphLite generate_regular_lite(vid_t n, int d, unsigned long seed, bool erase_parallel = true, GraphLite::reorder_mode_t reorder = GraphLite::REORDER_NONE)
+{
+    return GraphLite(n, graph_lite_generator::regular_edges(n, d, seed, erase_parallel), reorder);
+}
+
+inline GraphLite generate_lattice_lite(const std::vector<vid_t>& dims, bool periodic = false, int num_threads = 1, GraphLite::reorder_mode_t reorder = GraphLite::REORDER_NONE)
+{
+    vid_t n = 1;
+    for(auto s : dims)
+        n *= s;
+    return GraphLite(n, graph_lite_generator::lattice_edges(dims, periodic, num_threads), reorder);
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <vector>
+
+#include <cassert>
+#include <cstring>
+
+#include <algorithm>
+
+// Incident lists of all vertices, stored back to back in one pool instead of one heap vector per vertex
+// Every list owns a chunk of power-of-two capacity; a list outgrowing its chunk moves to a chunk twice as large,
+// and released chunks are kept in per-size free lists for reuse, so no heap call is needed after construction
+template<typename index_t>
+class IncidenceArena{
+public:
+
+    typedef struct slot{
+        size_t offset = 0;
+        size_t size = 0;
+        size_t capacity = 0; // 0 means no chunk is owned
+    }slot_t;
+
+    // Read-only view of one incident list, valid until the next modification of the arena
+    class span{
+    public:
+        span(const index_t* data, size_t size) : data_(data), size_(size){}
+        size_t size() const {return size_;}
+        const index_t& operator[](size_t i) const {assert(i < size_); return data_[i];}
+        const index_t* begin() const {return data_;}
+        const index_t* end() const {return data_ + size_;}
+        const index_t& back() const {assert(size_); return data_[size_-1];}
+    private:
+        const index_t* data_;
+        size_t size_;
+    };
+
+    IncidenceArena() = default;
+    IncidenceArena(const IncidenceArena& other){*this = other;}
+    IncidenceArena(IncidenceArena&& other) = default;
+    IncidenceArena& operator=(IncidenceArena&& other) = default;
+    IncidenceArena& operator=(const IncidenceArena& other){
+        // keep the reserved room of the pool, a plain vector copy would drop it
+        pool_.clear();
+        pool_.reserve(other.pool_.capacity());
+        pool_ = other.pool_;
+        slots_ = other.slots_;
+        free_head_ = other.free_head_;
+        return *this;
+    }
+
+    // Allocate every list with room for the given degree, and reserve the pool with (1 + headroom) of the total
+    void init(const std::vector<size_t>& degree, double headroom = 1.0){
+        clear();
+        slots_.resize(degree.size());
+        free_head_.assign(8 * sizeof(size_t), null_chunk);
+
+        size_t total = 0;
+        for(auto d : degree)
+            total += d ? chunk_capacity(d) : 0;
+        pool_.reserve(total + (size_t)(headroom * total));
+
+        for(size_t v = 0; v < degree.size(); v++)
+            if(degree[v])
+                slots_[v] = {allocate(degree[v]), 0, chunk_capacity(degree[v])};
+    }
+
+    void clear(){pool_.clear(); slots_.clear(); free_head_.clear();}
+
+    size_t size() const {return slots_.size();}
+    span operator[](size_t v) const {return span(pool_.data() + slots_[v].offset, slots_[v].size);}
+
+    index_t* data(size_t v){return pool_.data() + slots_[v].offset;}
+    const slot_t& slot(size_t v) const {return slots_[v];}
+
+    // Append, moving the list into a larger chunk if needed
+    void push_back(size_t v, index_t e){
+        reserve(v, slots_[v].size + 1);
+        pool_[slots_[v].offset + slots_[v].size++] = e;
+    }
+
+    void pop_back(size_t v){assert(slots_[v].size); slots_[v].size--;}
+
+    // Order is not kept: the last entry takes the place of the erased one
+    void erase(size_t v, size_t pos){
+        slot_t& s = slots_[v];
+        assert(pos < s.size);
+        pool_[s.offset + pos] = pool_[s.offset + s.size - 1];
+        s.size--;
+    }
+
+    // Exact inverse of erase(v, pos)
+    void unerase(size_t v, size_t pos, index_t e){
+        slot_t& s = slots_[v];
+        assert(pos <= s.size && s.size < s.capacity);
+        pool_[s.offset + s.size] = pool_[s.offset + pos];
+        pool_[s.offset + pos] = e;
+        s.size++;
+    }
+
+    // Change the size within the capacity, entries written through data(v) become part of the list
+    void resize(size_t v, size_t size){assert(size <= slots_[v].capacity); slots_[v].size = size;}
+
+    // Make room for at least n entries, list is moved by a single memcpy into a larger chunk if needed
+    void reserve(size_t v, size_t n){
+        if(n > slots_[v].capacity)
+            relocate(v, n);
+    }
+
+    // Move the list into a new chunk with room for at least n entries, returns the previous slot
+    // The previous chunk is only released if asked, so that it could be restored with set_slot later
+    slot_t relocate(size_t v, size_t n, bool release_old = true){
+        slot_t old = slots_[v];
+        assert(n >= old.size);
+
+        const size_t cap = chunk_capacity(n);
+        const size_t offset = allocate(n); // might move the pool
+
+        if(old.size)
+            std::memcpy(pool_.data() + offset, pool_.data() + old.offset, old.size * sizeof(index_t));
+
+        if(release_old && old.capacity)
+            release(old.offset, old.capacity);
+
+        slots_[v] = {offset, old.size, cap};
+        return old;
+    }
+
+    // Detach the list of v, and return its slot; the chunk is released only if asked
+    slot_t detach(size_t v, bool release_old = true){
+        slot_t old = slots_[v];
+        if(release_old && old.capacity)
+            release(old.offset, old.capacity);
+        slots_[v] = slot_t();
+        return old;
+    }
+
+    // Restore a slot obtained from relocate/detach, releasing whatever chunk v owns now
+    void set_slot(size_t v, const slot_t& s){
+        if(slots_[v].capacity && slots_[v].offset != s.offset)
+            release(slots_[v].offset, slots_[v].capacity);
+        slots_[v] = s;
+    }
+
+    // Hand the chunk of list u over to the empty list v
+    void move_slot(size_t u, size_t v){
+        assert(!slots_[v].capacity);
+        slots_[v] = slots_[u];
+        slots_[u] = slot_t();
+    }
+
+    size_t pool_capacity() const {return pool_.capacity();}
+
+private:
+
+    // chunks need to be large enough to hold the link of the free list
+    static constexpr size_t min_chunk = sizeof(size_t) > sizeof(index_t) ? sizeof(size_t) / sizeof(index_t) : 1;
+    static constexpr size_t null_chunk = (size_t)-1;
+
+    static size_t chunk_capacity(size_t n){
+        size_t c = min_chunk;
+        while(c < n)
+            c <<= 1;
+        return c;
+    }
+
+    static size_t chunk_class(size_t capacity){
+        size_t k = 0;
+        while((min_chunk << k) < capacity)
+            k++;
+        return k;
+    }
+
+    size_t allocate(size_t n){
+        const size_t cap = chunk_capacity(n);
+        const size_t k = chunk_class(cap);
+
+        // reuse a released chunk of the same size
+        if(k < free_head_.size() && free_head_[k] != null_chunk){
+            size_t offset = free_head_[k];
+            std::memcpy(&free_head_[k], pool_.data() + offset, sizeof(size_t));
+            return offset;
+        }
+
+        // bump allocation at the end of the pool, growing geometrically when out of room
+        size_t offset = pool_.size();
+        if(offset + cap > pool_.capacity())
+            pool_.reserve(std::max(2 * pool_.capacity(), offset + cap));
+        pool_.resize(offset + cap);
+        return offset;
+    }
+
+    void release(size_t offset, size_t capacity){
+        const size_t k = chunk_class(capacity);
+        if(k >= free_head_.size())
+            free_head_.resize(k + 1, null_chunk);
+
+        // link stored inside the released chunk itself
+        std::memcpy(pool_.data() + offset, &free_head_[k], sizeof(size_t));
+        free_head_[k] = offset;
+    }
+
+    std::vector<index_t> pool_;
+    std::vector<slot_t> slots_;
+    std::vector<size_t> free_head_; // first free chunk for each size class
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+// Effective resistances of the current graph by preconditioned conjugate gradient on its Laplacian
+// The probability of an edge to be in a uniform spanning tree is its effective resistance, which ApproxCountST
+// could use as the ratio of a pivot instead of sampling trees. The Laplacian is grounded at one live vertex,
+// which keeps it positive definite, and preconditioned by its diagonal.
+
+#include "graph_lite.hpp"
+
+#include <Eigen/Eigen>
+
+#include <vector>
+#include <cassert>
+
+template<typename graph_t>
+class LaplacianSolver{
+
+public:
+
+    typedef typename graph_t::vid_t vid_t;
+    typedef typename graph_t::eid_t eid_t;
+
+    LaplacianSolver(double tolerance = 1e-10, int max_iterations = 0) : tolerance(tolerance), max_iterations(max_iterations){}
+
+    // Assemble the Laplacian of the live vertices and valid edges, to be called again after every change of the graph
+    // Parallel edges add up, and in LAZY mode the endpoints are resolved with find()
+    void build(graph_t* gl){
+        const vid_t N = gl->vertex_count_all();
+        index.assign(N, graph_t::NO_VERTEX);
+        n = 0;
+        for(vid_t v = 0; v < N; v++)
+            if(gl->is_vertex_alive(v))
+                index[v] = n++;
+        assert(n == gl->vertex_count());
+
+        // the last live vertex is the ground, so only the first n-1 rows and columns are kept
+        std::vector<Eigen::Triplet<double>> entries;
+        entries.reserve(4 * (size_t)gl->edge_count());
+        for(eid_t e = 0; e < gl->edge_count_all(); e++){
+            if(!gl->is_edge_valid(e))
+                continue;
+            const vid_t a = index[gl->find(gl->edge(e).from)];
+            const vid_t b = index[gl->find(gl->edge(e).to)];
+            assert(a != graph_t::NO_VERTEX && b != graph_t::NO_VERTEX && a != b);
+            if(a + 1 < n){
+                entries.emplace_back(a, a, 1.0);
+                if(b + 1 < n)
+                    entries.emplace_back(a, b, -1.0);
+            }
+            if(b + 1 < n){
+                entries.emplace_back(b, b, 1.0);
+                if(a + 1 < n)
+                    entries.emplace_back(b, a, -1.0);
+            }
+        }
+
+        const Eigen::Index dim = n > 0 ? n - 1 : 0;
+        laplacian.resize(dim, dim);
+        laplacian.setFromTriplets(entries.begin(), entries.end()); // duplicates are summed
+
+        cg.setTolerance(tolerance);
+        if(max_iterations > 0)
+            cg.setMaxIterations(max_iterations);
+        cg.compute(laplacian);
+        gl_ = gl;
+    }
+
+    // Effective resistance between the current endpoints of e, adds the CG iterations to *iterations if given
+    double effective_resistance(eid_t e, long long* iterations = nullptr){
+        assert(gl_ && gl_->is_edge_valid(e));
+        const vid_t a = index[gl_->find(gl_->edge(e).from)];
+        const vid_t b = index[gl_->find(gl_->edge(e).to)];
+        return effective_resistance_between(a, b, iterations);
+    }
+
+    // number of CG iterations the last solve took, and its estimated relative residual
+    long long last_iterations() const {return cg.iterations();}
+    double last_error() const {return cg.error();}
+
+private:
+
+    // potential difference of a unit current from a to b, between compact indices
+    double effective_resistance_between(vid_t a, vid_t b, long long* iterations){
+        assert(a != b && n > 1);
+        const Eigen::Index dim = n - 1;
+
+        // the ground has potential 0, and is left out of the system
+        Eigen::VectorXd rhs = Eigen::VectorXd::Zero(dim);
+        if(a + 1 < n) rhs[a] = 1.0;
+        if(b + 1 < n) rhs[b] = -1.0;
+
+        const Eigen::VectorXd x = cg.solve(rhs);
+        if(iterations)
+            *iterations += cg.iterations();
+
+        const double xa = a + 1 < n ? x[a] : 0.0;
+        const double xb = b + 1 < n ? x[b] : 0.0;
+        return xa - xb;
+    }
+
+    const double tolerance;
+    const int max_iterations; // 0 for the default of Eigen, twice the dimension
+
+    graph_t* gl_ = nullptr;
+    std::vector<vid_t> index; // compact index of every live vertex
+    vid_t n = 0;
+
+    Eigen::SparseMatrix<double> laplacian;
+    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper, Eigen::DiagonalPreconditioner<double>> cg;
+};
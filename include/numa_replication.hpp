@@ -0,0 +1,183 @@
+#pragma once
+
+// Multi-threaded sampling over one graph on multi-socket hosts
+// ReplicatedGraph keeps one copy of the graph per NUMA node, each built by a thread pinned to that node, so that
+// its pages are placed there by first touch; ParallelTreeSampler runs pinned threads that only walk the copy of
+// their own node. Mutations are applied to every copy, between sampling rounds.
+
+#include "graph_lite.hpp"
+#include "random_spanning_trees.hpp"
+#include "numa_topology.hpp"
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <random>
+
+#include <cassert>
+
+template<typename graph_t>
+class ReplicatedGraph{
+
+public:
+
+    typedef typename graph_t::vid_t vid_t;
+    typedef typename graph_t::eid_t eid_t;
+    typedef typename graph_t::checkpoint_t checkpoint_t;
+
+    ReplicatedGraph() = delete;
+    // One replica per node of the topology if replicate, otherwise a single copy shared by all nodes, as a baseline
+    ReplicatedGraph(const graph_t& base, const NumaTopology& topology, bool replicate = true) : topology(topology){
+        replicas.resize(replicate ? topology.node_count() : 1);
+
+        std::vector<std::thread> builders;
+        for(int n = 0; n < (int)replicas.size(); n++)
+            builders.emplace_back([&, n](){
+                // the copy is allocated and written by a thread of the node, which places its pages there
+                NumaTopology::pin_this_thread(topology.node(n).cpus[0]);
+                replicas[n] = std::make_unique<graph_t>(base);
+                replicas[n]->release_journal();
+            });
+        for(auto& t : builders)
+            t.join();
+    }
+
+    const NumaTopology& numa_topology() const {return topology;}
+    int replica_count() const {return replicas.size();}
+    bool replicated() const {return replicas.size() > 1;}
+
+    // The copy to be read by threads of the given node
+    graph_t* replica(int node){return replicas[replicas.size() > 1 ? node : 0].get();}
+
+    // Mutations, applied in turn to every replica by the calling thread, no sampling may run meanwhile
+    // The incidence arenas are reserved with headroom, so the replicas rarely grow into pages of the caller's node
+    void contract_edge(eid_t e){
+        for(auto& g : replicas)
+            g->contract_edge(e);
+    }
+
+    void remove_edge(eid_t e){
+        for(auto& g : replicas)
+            g->remove_edge(e);
+    }
+
+    // All replicas see the same mutations, so their journals advance in step
+    std::vector<checkpoint_t> checkpoint(){
+        std::vector<checkpoint_t> cp;
+        for(auto& g : replicas)
+            cp.push_back(g->checkpoint());
+        return cp;
+    }
+
+    void rollback(const std::vector<checkpoint_t>& cp){
+        assert(cp.size() == replicas.size());
+        for(size_t n = 0; n < replicas.size(); n++)
+            replicas[n]->rollback(cp[n]);
+    }
+
+private:
+
+    const NumaTopology& topology;
+    std::vector<std::unique_ptr<graph_t>> replicas;
+};
+
+
+// Pinned threads drawing spanning trees of a ReplicatedGraph, each from the replica of its node
+template<typename graph_t>
+class ParallelTreeSampler{
+
+public:
+
+    typedef typename graph_t::vid_t vid_t;
+    typedef typename graph_t::eid_t eid_t;
+    typedef BasicRandomSpanningTrees<graph_t> sampler_t;
+
+    // called concurrently from the workers, with the worker index and the tree as concrete edges of the replica
+    typedef std::function<void(int, const std::vector<eid_t>&)> callback_t;
+
+    ParallelTreeSampler() = delete;
+    // Without pinning the threads are left to the scheduler, and all read the replica of node 0
+    // The replicas need EAGER contraction: find() of LAZY mode compresses paths, so it is not safe to read concurrently
+    ParallelTreeSampler(ReplicatedGraph<graph_t>* graphs, int num_threads, unsigned long seed, bool pin = true)
+        : graphs(graphs), num_threads(num_threads), seed(seed), pin(pin), workers(num_threads){
+        assert(graphs->replica(0)->contraction_mode() == graph_t::EAGER);
+    }
+
+    // Draw T trees over all threads, returns when all were handed to on_tree
+    template<typename engine_t = SamplerEngines::SAMPLER_ENGINE>
+    void sample(long long T, const callback_t& on_tree);
+
+    // Trees drawn ahead by buffering engines are of the graph before a mutation
+    void discard_buffered(){
+        for(auto& w : workers)
+            if(w.rst)
+                w.rst->discard_buffered();
+    }
+
+private:
+
+    typedef struct worker{
+        int node = 0;
+        std::unique_ptr<sampler_t> rst; // created by the worker thread, so that its walk state is local
+        std::vector<eid_t> path;
+        std::vector<eid_t> next;
+        std::vector<bool> in_tree;
+    }worker_t;
+
+    ReplicatedGraph<graph_t>* graphs;
+    const int num_threads;
+    const unsigned long seed;
+    const bool pin;
+
+    std::vector<worker_t> workers;
+};
+
+template<typename graph_t>
+template<typename engine_t>
+void ParallelTreeSampler<graph_t>::sample(long long T, const callback_t& on_tree)
+{
+    const long long CHUNK = 16; // trees claimed at once
+    std::atomic<long long> next_tree(0);
+
+    auto run = [&](int w){
+        worker_t& wk = workers[w];
+
+        int cpu = 0;
+        const int node = graphs->numa_topology().spread(w, &cpu);
+        if(pin)
+            NumaTopology::pin_this_thread(cpu);
+
+        if(!wk.rst){
+            wk.node = pin ? node : 0;
+
+            std::seed_seq seq{(unsigned int)(seed & 0xffffffff), (unsigned int)(seed >> 32), (unsigned int)w};
+            unsigned long s[2];
+            seq.generate(s, s + 2);
+            wk.rst = std::make_unique<sampler_t>(graphs->replica(wk.node), s[0] << 32 ^ s[1]);
+        }
+
+        graph_t* gl = graphs->replica(wk.node);
+        wk.next.resize(gl->vertex_count_all());
+        wk.in_tree.resize(gl->vertex_count_all());
+
+        for(long long t = next_tree.fetch_add(CHUNK); t < T; t = next_tree.fetch_add(CHUNK)){
+            for(long long i = t; i < std::min(T, t + CHUNK); i++){
+                const vid_t root = gl->random_connected_vertex(wk.rst->random_engine());
+                wk.rst->template get_st<engine_t>(&wk.path, root, &wk.next, &wk.in_tree);
+                on_tree(w, wk.path);
+            }
+        }
+    };
+
+    if(num_threads == 1 && !pin)
+        run(0);
+    else{
+        std::vector<std::thread> pool;
+        for(int w = 0; w < num_threads; w++)
+            pool.emplace_back(run, w);
+        for(auto& t : pool)
+            t.join();
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+// NUMA nodes and their cpus, read from sysfs, and pinning of threads to cpus
+// Only cpus the process is allowed to run on are listed; without sysfs (or off Linux) all cpus form a single node
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+class NumaTopology{
+
+public:
+
+    typedef struct node{
+        int id = 0; // sysfs node number
+        std::vector<int> cpus;
+    }node_t;
+
+    NumaTopology(){detect();}
+
+    int node_count() const {return nodes.size();}
+    const node_t& node(int i) const {return nodes[i];}
+
+    int cpu_count() const {
+        int n = 0;
+        for(const auto& nd : nodes)
+            n += nd.cpus.size();
+        return n;
+    }
+
+    // Placement of the i-th thread: threads are dealt to the nodes in turn, then to the cpus of the node,
+    // so that any number of threads is balanced over the nodes. Returns the node index, and the cpu in *cpu
+    int spread(int i, int* cpu) const {
+        const int n = i % node_count();
+        const auto& cpus = nodes[n].cpus;
+        *cpu = cpus[(i / node_count()) % cpus.size()];
+        return n;
+    }
+
+    // Node index of a cpu, 0 if unknown
+    int node_of_cpu(int cpu) const {
+        for(int n = 0; n < node_count(); n++)
+            for(auto c : nodes[n].cpus)
+                if(c == cpu)
+                    return n;
+        return 0;
+    }
+
+    // Bind the calling thread to one cpu, returns false if not supported or refused
+    static bool pin_this_thread(int cpu){
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    // Parse a sysfs cpu list such as "0-3,8,10-11"
+    static std::vector<int> parse_cpulist(const std::string& list){
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string range;
+        while(std::getline(ss, range, ',')){
+            if(range.empty() || range == "\n")
+                continue;
+            const auto dash = range.find('-');
+            const int lo = std::stoi(range.substr(0, dash));
+            const int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+            for(int c = lo; c <= hi; c++)
+                cpus.push_back(c);
+        }
+        return cpus;
+    }
+
+private:
+
+    void detect(){
+        nodes.clear();
+
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        const bool have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string line;
+        if(online && std::getline(online, line)){
+            for(int id : parse_cpulist(line)){
+                std::ifstream f("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+                std::string cpulist;
+                if(!f || !std::getline(f, cpulist))
+                    continue;
+
+                node_t nd;
+                nd.id = id;
+                for(int c : parse_cpulist(cpulist))
+                    if(!have_mask || CPU_ISSET(c, &allowed))
+                        nd.cpus.push_back(c);
+
+                // memory-only nodes, or nodes outside the affinity mask, get no threads
+                if(!nd.cpus.empty())
+                    nodes.push_back(nd);
+            }
+        }
+
+        if(nodes.empty() && have_mask){
+            node_t nd;
+            for(int c = 0; c < CPU_SETSIZE; c++)
+                if(CPU_ISSET(c, &allowed))
+                    nd.cpus.push_back(c);
+            if(!nd.cpus.empty())
+                nodes.push_back(nd);
+        }
+#endif
+
+        if(nodes.empty()){
+            node_t nd;
+            const int n = std::max(1u, std::thread::hardware_concurrency());
+            for(int c = 0; c < n; c++)
+                nd.cpus.push_back(c);
+            nodes.push_back(nd);
+        }
+    }
+
+    std::vector<node_t> nodes;
+};
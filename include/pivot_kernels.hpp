@@ -0,0 +1,157 @@
+#pragma once
+
+// Kernels over the struct-of-arrays pivot statistics of ApproxCountST
+// AVX2 versions are used when compiled for it (e.g. -march=native), otherwise the scalar loops
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace pivot_kernels{
+
+// same values as ApproxCountST::count_mode_t
+enum : int8_t{
+    MODE_UNSPECIFIED = 0,
+    MODE_PRESENCE,
+    MODE_ABSENCE
+};
+
+// Count one sample for the pivots from k on, as present if in_path[eid[k]], absent otherwise
+// Pivots not valid are skipped; stops after the first pivot whose mode disagrees with the outcome,
+// as the pivots after it are conditioned on the other outcome. Returns the index after the last pivot counted.
+// in_path needs 3 bytes of padding after the last edge, for the 32-bit gathers
+// The gathers take signed offsets, so they are only used when all edge ids, which are below K, fit in an int
+template<typename index_t>
+inline size_t ripple_sample(const index_t* eid, const int8_t* mode, const uint8_t* valid, const uint8_t* in_path,
+                            int* present, int* absent, size_t k, size_t K)
+{
+#ifdef __AVX2__
+    if constexpr (sizeof(index_t) == 4){
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i byte_mask = _mm256_set1_epi32(0xff);
+        const __m256i presence = _mm256_set1_epi32(MODE_PRESENCE);
+        const __m256i absence = _mm256_set1_epi32(MODE_ABSENCE);
+        const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        for(; K <= (size_t)INT32_MAX && k + 8 <= K; k += 8){
+            const __m256i e = _mm256_loadu_si256((const __m256i*)(eid + k));
+            const __m256i in = _mm256_cmpgt_epi32(_mm256_and_si256(_mm256_i32gather_epi32((const int*)in_path, e, 1), byte_mask), zero);
+            const __m256i v = _mm256_cmpgt_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(valid + k))), zero);
+            const __m256i m = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(mode + k)));
+
+            // disagreement: present but not counting presence, or absent but not counting absence
+            const __m256i differ = _mm256_blendv_epi8(
+                _mm256_xor_si256(_mm256_cmpeq_epi32(m, absence), _mm256_set1_epi32(-1)),
+                _mm256_xor_si256(_mm256_cmpeq_epi32(m, presence), _mm256_set1_epi32(-1)), in);
+            const int stop = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(differ, v)));
+
+            // lanes up to and including the first disagreement are counted
+            const int last = stop ? __builtin_ctz(stop) : 7;
+            const __m256i counted = _mm256_and_si256(v, _mm256_cmpgt_epi32(_mm256_set1_epi32(last + 1), lane));
+
+            // masks are -1, so subtracting adds one
+            __m256i p = _mm256_loadu_si256((const __m256i*)(present + k));
+            __m256i a = _mm256_loadu_si256((const __m256i*)(absent + k));
+            p = _mm256_sub_epi32(p, _mm256_and_si256(counted, in));
+            a = _mm256_sub_epi32(a, _mm256_andnot_si256(in, counted));
+            _mm256_storeu_si256((__m256i*)(present + k), p);
+            _mm256_storeu_si256((__m256i*)(absent + k), a);
+
+            if(stop)
+                return k + last + 1;
+        }
+    }
+#endif
+
+    for(; k < K; k++){
+        if(!valid[k])
+            continue;
+        if(in_path[eid[k]]){
+            present[k]++;
+            if(mode[k] != MODE_PRESENCE)
+                return k + 1;
+        }else{
+            absent[k]++;
+            if(mode[k] != MODE_ABSENCE)
+                return k + 1;
+        }
+    }
+    return K;
+}
+
+// min and max of a buffer of n doubles
+inline void buffer_minmax(const double* buf, int n, double* rmin, double* rmax)
+{
+    int i = 0;
+    double lo = buf[0], hi = buf[0];
+#ifdef __AVX2__
+    if(n >= 4){
+        __m256d vlo = _mm256_loadu_pd(buf), vhi = vlo;
+        for(i = 4; i + 4 <= n; i += 4){
+            const __m256d x = _mm256_loadu_pd(buf + i);
+            vlo = _mm256_min_pd(vlo, x);
+            vhi = _mm256_max_pd(vhi, x);
+        }
+        alignas(32) double l[4], h[4];
+        _mm256_store_pd(l, vlo);
+        _mm256_store_pd(h, vhi);
+        lo = std::min(std::min(l[0], l[1]), std::min(l[2], l[3]));
+        hi = std::max(std::max(h[0], h[1]), std::max(h[2], h[3]));
+    }
+#endif
+    for(; i < n; i++){
+        lo = std::min(lo, buf[i]);
+        hi = std::max(hi, buf[i]);
+    }
+    *rmin = lo;
+    *rmax = hi;
+}
+
+// sum and sum of squares of a buffer of n doubles
+inline void buffer_moments(const double* buf, int n, double* sum, double* sq_sum)
+{
+    int i = 0;
+    double s = 0.0, sq = 0.0;
+#ifdef __AVX2__
+    __m256d vs = _mm256_setzero_pd(), vsq = _mm256_setzero_pd();
+    for(; i + 4 <= n; i += 4){
+        const __m256d x = _mm256_loadu_pd(buf + i);
+        vs = _mm256_add_pd(vs, x);
+        vsq = _mm256_add_pd(vsq, _mm256_mul_pd(x, x));
+    }
+    alignas(32) double a[4], b[4];
+    _mm256_store_pd(a, vs);
+    _mm256_store_pd(b, vsq);
+    s = (a[0] + a[1]) + (a[2] + a[3]);
+    sq = (b[0] + b[1]) + (b[2] + b[3]);
+#endif
+    for(; i < n; i++){
+        s += buf[i];
+        sq += buf[i] * buf[i];
+    }
+    *sum = s;
+    *sq_sum = sq;
+}
+
+// Index of the first pivot in [k, K) with mode UNSPECIFIED, or K
+inline size_t first_unspecified(const int8_t* mode, size_t k, size_t K)
+{
+#ifdef __AVX2__
+    const __m256i zero = _mm256_setzero_si256();
+    for(; k + 32 <= K; k += 32){
+        const int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(mode + k)), zero));
+        if(mask)
+            return k + __builtin_ctz(mask);
+    }
+#endif
+    for(; k < K; k++)
+        if(mode[k] == MODE_UNSPECIFIED)
+            return k;
+    return K;
+}
+
+}
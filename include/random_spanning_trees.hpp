@@ -2,21 +2,106 @@
 
 #include "graph_lite.hpp"
 
-class RandomSpanningTrees{
+#include <random>
+
+// default engine of ApproxCountST::approx_count_st and ParallelTreeSampler::sample, a member of SamplerEngines
+#ifndef SAMPLER_ENGINE
+#define SAMPLER_ENGINE Wilson
+#endif
+
+// Sampling engines, all giving a uniform spanning tree of the live graph, selected at compile time through get_st<engine_t>
+// Shared by all index widths, so that the same tag names the engine of any BasicRandomSpanningTrees
+struct SamplerEngines{
+    struct Wilson{static constexpr const char* name = "wilson";};             // loop-erased random walks
+    struct CyclePopping{static constexpr const char* name = "cycle-popping";}; // Propp-Wilson popping of the cycles of the successor stacks
+    struct AldousBroder{static constexpr const char* name = "aldous-broder";}; // first entrance edges of a cover walk
+    struct WilsonInterleaved{static constexpr const char* name = "wilson-interleaved"; static constexpr int width = 8;}; // width trees in lockstep, buffered
+};
+
+template<typename graph_t>
+class BasicRandomSpanningTrees : public SamplerEngines{
 
 public:
 
+    typedef typename graph_t::vid_t vid_t;
+    typedef typename graph_t::eid_t eid_t;
 
+    // every sampler owns its random stream, so that samplers could run concurrently
+    BasicRandomSpanningTrees(graph_t* gl, unsigned long seed = 0) : gl(gl), rng(seed){}
 
-    RandomSpanningTrees(GraphLite* gl) : gl(gl){}
+    std::mt19937_64& random_engine(){return rng;}
 
+    // The tree is written to path as concrete edges, next and in_tree are working space of size vertex_count_all()
+    template<typename engine_t>
+    int get_st(std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree){
+        return get_st(engine_t(), path, root, next, in_tree);
+    }
     
     // Wilson's Algorithm Implementation
     int wilsons_get_st(std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree);
 
+    // Cycle popping, every vertex draws its successor up front, then cycles are popped until the successors form a tree
+    int cycle_popping_get_st(std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree);
+
+    // Aldous-Broder, a single walk from the root until all vertices are visited
+    int aldous_broder_get_st(std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree);
+
+    // Wilson's Algorithm on G trees at once, rooted at root, stored in the buffer drawn by get_st<WilsonInterleaved>
+    // Every walk step is split in stages, each issuing the prefetch of what the next stage reads, and the walks
+    // advance one stage in turn, so that the cache misses of different walks overlap
+    int wilsons_get_st_interleaved(int G, vid_t root);
+
+    // Drop the buffered trees, which are only valid until the graph is modified
+    void discard_buffered(){buffered.clear();}
+
 private:
 
-    GraphLite* gl = nullptr;
+    // engine dispatch of get_st
+    int get_st(Wilson, std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree){
+        return wilsons_get_st(path, root, next, in_tree);
+    }
+    int get_st(CyclePopping, std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree){
+        return cycle_popping_get_st(path, root, next, in_tree);
+    }
+    int get_st(AldousBroder, std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree){
+        return aldous_broder_get_st(path, root, next, in_tree);
+    }
+    inline int get_st(WilsonInterleaved, std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree);
+
+    typedef struct walker{
+        enum stage_t{NEXT_START = 0, WALK_SLOT, WALK_LIST, WALK_EDGE, WALK_MOVE, DONE};
+
+        std::vector<eid_t> path;
+        std::vector<eid_t> next;
+        std::vector<bool> in_tree;
+        vid_t i; // start of the current walk
+        vid_t u; // current vertex
+        eid_t e; // edge drawn at u
+        stage_t stage;
+    }walker_t;
+
+    std::vector<walker_t> walkers;
+    std::vector<std::vector<eid_t>> buffered; // trees of the interleaved walks not handed out yet
+
+    graph_t* gl = nullptr;
+    std::mt19937_64 rng;
+
+    std::vector<unsigned int> walk_mark; // cycle popping, vertices on the current walk
     
 };
 
+template<typename graph_t>
+int BasicRandomSpanningTrees<graph_t>::get_st(WilsonInterleaved, std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree)
+{
+    (void)next; (void)in_tree; // every walk has its own
+
+    if(buffered.empty())
+        wilsons_get_st_interleaved(WilsonInterleaved::width, root);
+
+    path->swap(buffered.back());
+    buffered.pop_back();
+    return IGRAPH_SUCCESS;
+}
+
+typedef BasicRandomSpanningTrees<GraphLite> RandomSpanningTrees;
+typedef BasicRandomSpanningTrees<GraphLite64> RandomSpanningTrees64;
@@ -0,0 +1,204 @@
+#pragma once
+
+// Log-determinant of the reduced Laplacian, the log of the spanning tree count, by stochastic Lanczos quadrature
+// log det(L) = tr(log L) is estimated by Hutchinson probes z^T log(L) z with Rademacher vectors z, each of them
+// by Gauss quadrature from m steps of Lanczos started at z. The Laplacian is never formed: its products are
+// taken from the incidence lists of GraphLite, so memory stays O(N m) per thread, against O(N^2) for mtt.hpp.
+// Probes are independent, each thread runs its own, so the mat-vecs of different probes run concurrently.
+
+#include "graph_lite.hpp"
+
+#include <Eigen/Eigen>
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <cmath>
+#include <cassert>
+
+template<typename graph_t>
+class SLQLogDet{
+
+public:
+
+    typedef typename graph_t::vid_t vid_t;
+    typedef typename graph_t::eid_t eid_t;
+
+    typedef struct slq_result{
+        double logdet = 0.0; // mean of the probes
+        double std_error = 0.0; // standard error of the mean over the probes
+        double ci_low = 0.0; // confidence interval of the mean, from the normal approximation
+        double ci_high = 0.0;
+        int probes = 0;
+        int lanczos_steps = 0;
+        long long matvecs = 0;
+    }result_t;
+
+    // z is the normal quantile of the confidence interval, 1.96 for 95%
+    SLQLogDet(int probes = 32, int lanczos_steps = 64, int num_threads = 1, unsigned long seed = 0, double z = 1.96)
+        : probes(probes), lanczos_steps(lanczos_steps), num_threads(num_threads), seed(seed), z(z){}
+
+    // Estimate for the current graph; LAZY graphs are compacted first, so that the incident lists hold resolved edges
+    result_t estimate(graph_t* gl);
+
+private:
+
+    // y = L x, L the Laplacian without the row and column of the ground vertex
+    void laplacian_product(const Eigen::VectorXd& x, Eigen::VectorXd* y) const;
+
+    // quadrature of z^T log(L) z for one probe, its random stream only depends on the probe index
+    double probe(int p, long long* matvecs) const;
+
+    const int probes;
+    const int lanczos_steps;
+    const int num_threads;
+    const unsigned long seed;
+    const double z;
+
+    graph_t* gl = nullptr;
+    std::vector<vid_t> vertex; // live vertex of every row
+    std::vector<vid_t> index; // row of every vertex, NO_VERTEX for the ground and dead vertices
+};
+
+template<typename graph_t>
+typename SLQLogDet<graph_t>::result_t SLQLogDet<graph_t>::estimate(graph_t* g)
+{
+    gl = g;
+    if(gl->contraction_mode() == graph_t::LAZY)
+        gl->compact();
+
+    // rows of the live vertices, the last one being the ground
+    const vid_t N = gl->vertex_count_all();
+    vertex.clear();
+    index.assign(N, graph_t::NO_VERTEX);
+    for(vid_t v = 0; v < N; v++)
+        if(gl->is_vertex_alive(v)){
+            index[v] = vertex.size();
+            vertex.push_back(v);
+        }
+
+    result_t res;
+    if(vertex.size() <= 1)
+        return res;
+
+    index[vertex.back()] = graph_t::NO_VERTEX;
+    vertex.pop_back();
+
+    res.probes = probes;
+    res.lanczos_steps = std::min<long long>(lanczos_steps, vertex.size());
+
+    std::vector<double> estimates(probes);
+    std::atomic<int> next_probe(0);
+    std::atomic<long long> matvecs(0);
+
+    auto worker = [&](){
+        long long local = 0;
+        for(int p = next_probe++; p < probes; p = next_probe++)
+            estimates[p] = probe(p, &local);
+        matvecs += local;
+    };
+
+    if(num_threads <= 1)
+        worker();
+    else{
+        std::vector<std::thread> pool;
+        for(int t = 0; t < num_threads; t++)
+            pool.emplace_back(worker);
+        for(auto& t : pool)
+            t.join();
+    }
+
+    for(auto e : estimates)
+        res.logdet += e;
+    res.logdet /= probes;
+
+    if(probes > 1){
+        double var = 0.0;
+        for(auto e : estimates)
+            var += (e - res.logdet) * (e - res.logdet);
+        var /= probes - 1;
+        res.std_error = std::sqrt(var / probes);
+    }
+    res.ci_low = res.logdet - z * res.std_error;
+    res.ci_high = res.logdet + z * res.std_error;
+    res.matvecs = matvecs;
+
+    return res;
+}
+
+template<typename graph_t>
+void SLQLogDet<graph_t>::laplacian_product(const Eigen::VectorXd& x, Eigen::VectorXd* y) const
+{
+    const size_t n = vertex.size();
+    for(size_t i = 0; i < n; i++){
+        const vid_t v = vertex[i];
+        double sum = 0.0;
+        for(auto e : gl->inclist()[v]){
+            // bundles of parallel edges count with their multiplicity
+            const double w = gl->multiplicity(e);
+            const vid_t j = index[gl->edge_other_end(e, v)];
+            sum += w * (j == graph_t::NO_VERTEX ? x[i] : x[i] - x[j]);
+        }
+        (*y)[i] = sum;
+    }
+}
+
+template<typename graph_t>
+double SLQLogDet<graph_t>::probe(int p, long long* matvecs) const
+{
+    const Eigen::Index n = vertex.size();
+    const int m = std::min<Eigen::Index>(lanczos_steps, n);
+
+    std::seed_seq seq{(unsigned int)(seed & 0xffffffff), (unsigned int)(seed >> 32), (unsigned int)p};
+    std::mt19937_64 rng(seq);
+
+    // Rademacher probe, normalised, so that z^T f(L) z = n e1^T f(T) e1
+    Eigen::VectorXd q(n), q_prev = Eigen::VectorXd::Zero(n), w(n);
+    for(Eigen::Index i = 0; i < n; i++)
+        q[i] = (rng() & 1) ? 1.0 : -1.0;
+    q /= std::sqrt((double)n);
+
+    std::vector<double> alpha, beta;
+    alpha.reserve(m);
+    beta.reserve(m);
+
+    for(int k = 0; k < m; k++){
+        laplacian_product(q, &w);
+        (*matvecs)++;
+
+        const double a = q.dot(w);
+        alpha.push_back(a);
+        if(k + 1 == m)
+            break;
+
+        w -= a * q;
+        if(k > 0)
+            w -= beta.back() * q_prev;
+
+        const double b = w.norm();
+        if(b < 1e-10 * std::abs(a)) // invariant subspace, the quadrature is exact
+            break;
+        beta.push_back(b);
+
+        q_prev.swap(q);
+        q = w / b;
+    }
+
+    // Gauss quadrature: nodes are the eigenvalues of T, weights the squared first components of its eigenvectors
+    const int s = alpha.size();
+    Eigen::MatrixXd T = Eigen::MatrixXd::Zero(s, s);
+    for(int k = 0; k < s; k++){
+        T(k, k) = alpha[k];
+        if(k + 1 < s)
+            T(k, k + 1) = T(k + 1, k) = beta[k];
+    }
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(T);
+
+    double quad = 0.0;
+    for(int k = 0; k < s; k++){
+        const double tau = eig.eigenvectors()(0, k);
+        quad += tau * tau * std::log(eig.eigenvalues()[k]);
+    }
+    return n * quad;
+}
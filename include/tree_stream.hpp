@@ -0,0 +1,172 @@
+#pragma once
+
+// Binary stream of spanning trees, as written by BulkTreeSampler
+// A fixed header, then one record per tree, in tree index order:
+//   PARENT: the parent of every vertex towards the root, NO_VERTEX for the root, index_bytes each;
+//           records have a fixed size, so tree i of a mapped file is found without decoding the ones before it
+//   DELTA:  the byte length of the record, then the sorted edge ids, the first one and then the gaps,
+//           all as LEB128 varints; about one or two bytes per edge on graphs with locality
+// Ids are those of the graph the sampler was given before any reordering. Fields are in host byte order.
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace tree_stream{
+
+enum encoding_t : uint32_t{
+    ENCODING_PARENT = 0,
+    ENCODING_DELTA
+};
+
+enum : uint32_t{
+    FLAG_PER_TREE_SEEDS = 1 // tree i was drawn from a stream seeded by (seed, i) alone
+};
+
+typedef struct header{
+    char magic[4] = {'U', 'S', 'T', 'S'};
+    uint32_t version = 1;
+    uint32_t encoding = ENCODING_PARENT;
+    uint32_t index_bytes = 4; // width of the vertex ids of PARENT records
+    uint64_t vertices = 0;
+    uint64_t edges = 0;
+    uint64_t trees = 0;
+    uint64_t seed = 0;
+    uint32_t flags = 0;
+    uint32_t reserved = 0;
+}header_t;
+
+static_assert(sizeof(header_t) == 56, "header layout");
+
+inline void put_varint(uint64_t x, std::vector<uint8_t>* out)
+{
+    while(x >= 0x80){
+        out->push_back((uint8_t)(x | 0x80));
+        x >>= 7;
+    }
+    out->push_back((uint8_t)x);
+}
+
+inline uint64_t get_varint(const uint8_t** p)
+{
+    uint64_t x = 0;
+    for(int shift = 0; ; shift += 7){
+        const uint8_t b = *(*p)++;
+        x |= (uint64_t)(b & 0x7f) << shift;
+        if(!(b & 0x80))
+            return x;
+    }
+}
+
+// Append the record of one tree, given as edge ids; edges is sorted in place
+inline void encode_delta(std::vector<uint64_t>* edges, std::vector<uint8_t>* out)
+{
+    std::sort(edges->begin(), edges->end());
+
+    thread_local std::vector<uint8_t> body;
+    body.clear();
+    uint64_t prev = 0;
+    for(auto e : *edges){
+        put_varint(e - prev, &body);
+        prev = e;
+    }
+
+    put_varint(body.size(), out);
+    out->insert(out->end(), body.begin(), body.end());
+}
+
+// Append the record of one tree, given as the parent of every vertex
+template<typename index_t>
+inline void encode_parent(const std::vector<index_t>& parent, std::vector<uint8_t>* out)
+{
+    const size_t at = out->size();
+    out->resize(at + parent.size() * sizeof(index_t));
+    std::memcpy(out->data() + at, parent.data(), parent.size() * sizeof(index_t));
+}
+
+
+// Read-only view of a tree stream file, mapped into memory
+class Reader{
+
+public:
+
+    Reader(const std::string& path){
+        fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            return;
+        struct stat st;
+        if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header_t))
+            return;
+        size = st.st_size;
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED)
+            return;
+        data = (const uint8_t*)p;
+        std::memcpy(&hdr, data, sizeof(hdr));
+        cursor = data + sizeof(header_t);
+    }
+
+    ~Reader(){
+        if(data)
+            munmap((void*)data, size);
+        if(fd >= 0)
+            ::close(fd);
+    }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    bool good() const {return data && std::memcmp(hdr.magic, "USTS", 4) == 0 && hdr.version == 1;}
+    const header_t& header() const {return hdr;}
+
+    // trees fully present in the file, fewer than header().trees if the writer was interrupted
+    uint64_t parent_trees() const {
+        assert(hdr.encoding == ENCODING_PARENT);
+        return (size - sizeof(header_t)) / (hdr.vertices * hdr.index_bytes);
+    }
+
+    // PARENT: the parent array of tree i, without copying
+    template<typename index_t>
+    const index_t* parents(uint64_t i) const {
+        assert(hdr.encoding == ENCODING_PARENT && sizeof(index_t) == hdr.index_bytes && i < parent_trees());
+        return (const index_t*)(data + sizeof(header_t) + i * hdr.vertices * hdr.index_bytes);
+    }
+
+    // DELTA: decode the next tree into sorted edge ids, false at the end of the file
+    bool next(std::vector<uint64_t>* edges){
+        assert(hdr.encoding == ENCODING_DELTA);
+        edges->clear();
+        if(cursor >= data + size)
+            return false;
+        const uint64_t length = get_varint(&cursor);
+        const uint8_t* end = cursor + length;
+        if(end > data + size)
+            return false;
+        uint64_t e = 0;
+        while(cursor < end){
+            e += get_varint(&cursor);
+            edges->push_back(e);
+        }
+        return true;
+    }
+
+private:
+
+    int fd = -1;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    header_t hdr;
+    const uint8_t* cursor = nullptr; // next DELTA record
+};
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "graph_lite.hpp"
+#include "approx_count_st.hpp"
+#include "numa_topology.hpp"
+
+#include <vector>
+#include <functional>
+
+// Run independent trials of ApproxCountST on a pool of threads
+// The base graph is only read: each worker builds its own working copy once, and rolls it back after every trial
+// With pinning, workers are bound to cpus spread over the NUMA nodes before making their copy, which then stays local
+class TrialScheduler{
+
+public:
+
+    typedef struct trial_result{
+        int trial = 0;
+        int worker = 0;
+        double seconds = 0.0; // wall clock time of this trial
+        ApproxCountST::result_t res;
+    }trial_result_t;
+
+    typedef struct trial_summary{
+        int trials = 0;
+        double mean_count_log = 0.0;
+        double var_count_log = 0.0; // unbiased sample variance
+        double mean_error = 0.0; // error rate versus the reference count, e^(count_log - ref_log) - 1
+        double var_error = 0.0;
+        double mean_seconds = 0.0;
+        double mean_actual_samples = 0.0; // samples drawn per trial, rippled ones not counted again
+        double total_seconds = 0.0; // wall clock time of the whole run
+    }summary_t;
+
+    // called from worker threads as every trial completes, calls are serialised
+    typedef std::function<void(const trial_result_t&)> callback_t;
+
+    TrialScheduler() = delete;
+    TrialScheduler(const GraphLite* base, int num_threads, unsigned long seed, bool pin_threads = false)
+        : base(base), num_threads(num_threads), seed(seed), pin_threads(pin_threads){}
+
+    // results are ordered by trial index, which also decides the random stream of the trial, regardless of threads
+    std::vector<trial_result_t> run(int L, const callback_t& on_complete = nullptr);
+
+    // aggregate the results of the last run against a reference count, e.g. the MTT result
+    summary_t summarise(const std::vector<trial_result_t>& results, double ref_count_log) const;
+
+    unsigned long trial_seed(int trial) const;
+
+    // budget of every trial, see ApproxCountST::budget_t
+    void set_budget(const ApproxCountST::budget_t& b){budget = b;}
+
+private:
+
+    const GraphLite* base;
+    const int num_threads;
+    const unsigned long seed;
+    const bool pin_threads;
+    NumaTopology topology;
+    ApproxCountST::budget_t budget;
+
+    double run_seconds = 0.0;
+};
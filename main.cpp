@@ -8,15 +8,40 @@
 #include <graph_lite.hpp>
 
 #include <stdio.h>
+#include <chrono>
 
 #include <mtt.hpp>
+#include <slq_logdet.hpp>
 
+#include <trial_scheduler.hpp>
 
-ApproxCountST::convergence_mode_t ApproxCountST::convergence_mode = CONVERGENCE_MODE;
-double ApproxCountST::convergence_ratio_threshold = RATIO_THRESHOLD_DEFAULT;
-double ApproxCountST::convergence_variance_threshold = VARIANCE_THRESHOLD_DEFAULT;
-int ApproxCountST::convergence_constant_threshold = CONSTANT_THRESHOLD_DEFAULT;
-int ApproxCountST::initial_requested_batch_size = INITIAL_REQUESTED_BATCH_SIZE;
+
+#ifndef EDGE_ORDER
+#define EDGE_ORDER ApproxCountST::ORDER_IDENTITY
+#endif
+
+#ifndef RATIO_ENGINE
+#define RATIO_ENGINE ApproxCountST::ENGINE_SAMPLING
+#endif
+
+#ifndef RESISTANCE_TOLERANCE_DEFAULT
+#define RESISTANCE_TOLERANCE_DEFAULT 1e-10
+#endif
+
+#ifndef GRAPH_REORDER
+#define GRAPH_REORDER GraphLite::REORDER_NONE
+#endif
+
+ApproxCountSTConfig::convergence_mode_t ApproxCountSTConfig::convergence_mode = CONVERGENCE_MODE;
+double ApproxCountSTConfig::convergence_ratio_threshold = RATIO_THRESHOLD_DEFAULT;
+double ApproxCountSTConfig::convergence_variance_threshold = VARIANCE_THRESHOLD_DEFAULT;
+int ApproxCountSTConfig::convergence_constant_threshold = CONSTANT_THRESHOLD_DEFAULT;
+int ApproxCountSTConfig::initial_requested_batch_size = INITIAL_REQUESTED_BATCH_SIZE;
+ApproxCountSTConfig::edge_order_t ApproxCountSTConfig::edge_order = EDGE_ORDER;
+ApproxCountSTConfig::ratio_engine_t ApproxCountSTConfig::ratio_engine = RATIO_ENGINE;
+double ApproxCountSTConfig::resistance_tolerance = RESISTANCE_TOLERANCE_DEFAULT;
+int ApproxCountSTConfig::exact_tail_vertex_threshold = EXACT_TAIL_VERTEX_THRESHOLD_DEFAULT;
+int ApproxCountSTConfig::exact_tail_edge_threshold = EXACT_TAIL_EDGE_THRESHOLD_DEFAULT;
 
 void log2file(FILE* fp, const char *__restrict __format, ...)
 {
@@ -35,7 +60,7 @@ int main(int argc, char* argv[])
 
 	if (argc < 4) {
         // Tell the user how to run the program
-       printf("Usage: %s NUM_OF_VERTICES NUM_OF_LOOPS THRESHOLD [BATCH_SIZE]\n", argv[0] );
+       printf("Usage: %s NUM_OF_VERTICES NUM_OF_LOOPS THRESHOLD [BATCH_SIZE] [NUM_OF_THREADS] [SECONDS_PER_TRIAL]\n", argv[0] );
         /* "Usage messages" are a conventional way of telling the user
          * how to run a program if they enter the command incorrectly.
          */
@@ -55,6 +80,13 @@ int main(int argc, char* argv[])
 	if(argc >= 5)
 		ApproxCountST::initial_requested_batch_size = atoi(argv[4]);
 
+	const int num_threads = argc >= 6 ? std::max(1, atoi(argv[5])) : 1;
+
+	// anytime mode, every trial returns its best estimate when its time is up
+	ApproxCountST::budget_t budget;
+	if(argc >= 7)
+		budget.seconds = atof(argv[6]);
+
 	// txt file
 	FILE *fp;
 	char filename[200];
@@ -107,10 +139,18 @@ int main(int argc, char* argv[])
 	// VECTOR(dimvector)[2]=10;
 	// igraph_lattice(&g, &dimvector, 0, IGRAPH_UNDIRECTED, 0,1);
 
-	GraphLite gl(&g);
+	GraphLite gl(&g, GRAPH_REORDER);
+
+#ifdef LAZY_CONTRACTION
+	gl.set_contraction_mode(GraphLite::LAZY);
+#endif
+
+#ifdef COLLAPSE_PARALLEL
+	gl.set_collapse_parallel(true);
+#endif
 
 	
-	log2file(fp, "Created graph with %d vertices and %d edges\n", gl.vertex_count_all() , gl.edge_count_all());
+	log2file(fp, "Created graph with %u vertices and %u edges\n", gl.vertex_count_all() , gl.edge_count_all());
 	fflush(fp);
 
 
@@ -138,50 +178,87 @@ int main(int argc, char* argv[])
 
 	igraph_destroy(&g);
 
+	// matrix-free estimate, as a cross-check of MTT, and of approx_count_st where MTT does not scale
+	auto slq_begin = std::chrono::steady_clock::now();
+	const auto slq = SLQLogDet<GraphLite>(32, 64, num_threads, 123).estimate(&gl);
+	auto slq_end = std::chrono::steady_clock::now();
+
+	log2file(fp, "SLQ Result = (e^%.4e), 95%% interval [e^%.4e, e^%.4e], %lld mat-vecs, %.3lf seconds\n\n",
+		slq.logdet, slq.ci_low, slq.ci_high, slq.matvecs, std::chrono::duration<double>(slq_end - slq_begin).count());
+
 	//////////////////////////////////////////////////////////////////////////////////////////
 
 	//// Logging Parameters
 
 	char params[1024];
-	sprintf(params,"N=%d, M=%d, presample_size=%d, buffer_size=%d, convergence_mode=%d, threshold=%lf, initial_batch_size=%d\n", N, gl.edge_count_all(), PRESAMPLE_SIZE_REQUIRED, PIVOT_BUFFER_SIZE, CONVERGENCE_MODE, threshold, ApproxCountST::initial_requested_batch_size);
+	sprintf(params,"N=%d, M=%u, presample_size=%d, buffer_size=%d, convergence_mode=%d, threshold=%lf, initial_batch_size=%d, edge_order=%d, ratio_engine=%d\n", N, gl.edge_count_all(), PRESAMPLE_SIZE_REQUIRED, PIVOT_BUFFER_SIZE, CONVERGENCE_MODE, threshold, ApproxCountST::initial_requested_batch_size, ApproxCountST::edge_order, ApproxCountST::ratio_engine);
 
 	log2file(fp, "%s", params);
 	fprintf(fp_csv,"%s", params);
 
-	ApproxCountST::result_t res;
-	
 	fprintf(fp_csv,"trial, count_log, mtt_log, time_spent, error rate, actual samples\n");
 	log2file(fp,"stats writting to file %s\n", filename);
+	log2file(fp,"running %d trials on %d threads\n", L, num_threads);
 
 	fflush(fp_csv);
 	fflush(fp);
 
-	for (int l = 0; l < L; l++){
+	// trials run concurrently, each with its own random stream decided by the trial index
+#ifdef PIN_THREADS
+	TrialScheduler scheduler(&gl, num_threads, 123, true);
+	log2file(fp,"workers pinned over %d NUMA nodes\n", NumaTopology().node_count());
+#else
+	TrialScheduler scheduler(&gl, num_threads, 123);
+#endif
+	scheduler.set_budget(budget);
+	if(budget.limited())
+		log2file(fp,"budget of %.3lf seconds per trial\n", budget.seconds);
 
-		GraphLite gl_temp = gl;
+	auto trials = scheduler.run(L, [&](const TrialScheduler::trial_result_t& t){
+		const auto& res = t.res;
+		const int l = t.trial;
 
 		log2file(fp,"<<<<<<<<<<<ROUND %d<<<<<<<<<<<<<<\n", l+1);
-		begin = clock();
-		ApproxCountST* ast = new ApproxCountST(&gl_temp); // putting on heap is needed, otherwise double free error
-		res = ast->approx_count_st();
 
-		end = clock();
-
-		log2file(fp,"%lld actual samples taken, with per sample time taking %.3lf ms\n", res.actual_samples, (double)(end - begin) / res.actual_samples / CLOCKS_PER_SEC * 1e3);
+		log2file(fp,"%lld actual samples taken, with per sample time taking %.3lf ms\n", res.actual_samples, t.seconds / res.actual_samples * 1e3);
 		
 
-		log2file(fp,"ROUND %d FINAL result = %.4e (e^%.4e) with %lld effective samples, avg %d samples per edge. \n", 
+		if(res.solver_iterations)
+			log2file(fp,"%lld conjugate gradient iterations for the resistances of the pivots\n", res.solver_iterations);
+
+		if(res.exact_tail_pivot >= 0)
+			log2file(fp,"pivots from %lld of %u counted exactly on the residual graph (e^%.4e)\n", res.exact_tail_pivot, gl.edge_count_all(), res.exact_tail_log);
+
+		if(res.estimated_tail_pivot >= 0)
+			log2file(fp,"pivots from %lld of %u estimated by SLQ on the residual graph\n", res.estimated_tail_pivot, gl.edge_count_all());
+
+		if(budget.limited())
+			log2file(fp,"budget %s, %lld pivots forced before convergence\n", res.budget_exhausted ? "exhausted" : "kept", res.forced_pivots);
+
+		log2file(fp,"count_log standard error %.4e\n", res.count_log_std_error);
+
+		log2file(fp,"ROUND %d FINAL result = %.4e (e^%.4e) with %lld effective samples, avg %lld samples per edge. \n", 
 			l+1, res.count, res.count_log, res.effective_samples, res.effective_samples / gl.edge_count_all());
 
 		log2file(fp,"error percentage %.2lf%%", 100.0 * (std::exp(res.count_log - logdet_value) - 1.0) );
-		log2file(fp,", time spent for randomised algo: %ld seconds\n\n", (end - begin) / CLOCKS_PER_SEC);
+		log2file(fp,", time spent for randomised algo: %.3lf seconds\n\n", t.seconds);
 
-		fprintf(fp_csv, "%d, %.4e, %.4e, %ld, %.4lf, %lld\n", l+1, res.count_log, logdet_value, (end - begin) / CLOCKS_PER_SEC, (std::exp(res.count_log - logdet_value) - 1.0), res.actual_samples);
+		fprintf(fp_csv, "%d, %.4e, %.4e, %.3lf, %.4lf, %lld\n", l+1, res.count_log, logdet_value, t.seconds, (std::exp(res.count_log - logdet_value) - 1.0), res.actual_samples);
 		fflush(fp_csv);
 		fflush(fp);
-		delete ast;
-		ast = nullptr;
-	}
+	});
+
+	//// Aggregated stats over all trials
+
+	const auto summary = scheduler.summarise(trials, logdet_value);
+
+	log2file(fp,"SUMMARY of %d trials: mean count_log = %.4e, variance %.4e, mean error percentage %.2lf%% (stddev %.2lf%%), wall time %.3lf seconds\n",
+		summary.trials, summary.mean_count_log, summary.var_count_log, 100.0 * summary.mean_error, 100.0 * std::sqrt(summary.var_error), summary.total_seconds);
+	log2file(fp,"edge order %d: mean %.0lf actual samples per trial\n", ApproxCountST::edge_order, summary.mean_actual_samples);
+
+	fprintf(fp_csv,"trials, mean count_log, var count_log, mtt_log, mean error rate, var error rate, mean time_spent, wall time, edge order, mean actual samples\n");
+	fprintf(fp_csv,"%d, %.4e, %.4e, %.4e, %.4lf, %.4e, %.3lf, %.3lf, %d, %.0lf\n", summary.trials, summary.mean_count_log, summary.var_count_log, logdet_value,
+		summary.mean_error, summary.var_error, summary.mean_seconds, summary.total_seconds, ApproxCountST::edge_order, summary.mean_actual_samples);
 	
 	fclose(fp);
 	fclose(fp_csv);
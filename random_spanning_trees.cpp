@@ -1,12 +1,13 @@
 #include <random_spanning_trees.hpp>
 #include <assert.h>
 
-int RandomSpanningTrees::wilsons_get_st(std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree)
+template<typename graph_t>
+int BasicRandomSpanningTrees<graph_t>::wilsons_get_st(std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree)
 {   
 
     const vid_t N = gl->vertex_count_all(); // The count may change every time
 
-    assert(gl->inclist()[root].size()); // assert reachability of the root
+    assert(gl->is_vertex_alive(root)); // assert reachability of the root
 
     // in_tree should be initialised to 0
     std::fill(in_tree->begin(), in_tree->end(), false);
@@ -17,11 +18,9 @@ int RandomSpanningTrees::wilsons_get_st(std::vector<eid_t> *path, vid_t root, st
     path->clear(); // capacity unchanged
     path->reserve(gl->vertex_count()-1);
 
-    RNG_BEGIN();
-
     for (vid_t i = 0; i < N; i++)
     {
-        if (!gl->inclist()[i].size())
+        if (!gl->is_vertex_alive(i))
             continue;
         
         vid_t u = i;
@@ -29,8 +28,7 @@ int RandomSpanningTrees::wilsons_get_st(std::vector<eid_t> *path, vid_t root, st
         while(!(*in_tree)[u])
         {
             // generate random successor
-            auto& edges = gl->inclist()[u]; // O(1)
-            eid_t edge = edges[ RNG_INTEGER(0, edges.size() - 1) ];
+            eid_t edge = gl->random_incident_edge(u, rng); // O(1)
             
             (*next)[u] = edge;
             u = gl->edge_other_end(edge, u); // O(1)
@@ -44,13 +42,204 @@ int RandomSpanningTrees::wilsons_get_st(std::vector<eid_t> *path, vid_t root, st
             (*in_tree)[u] = true;
 
             eid_t edge = (*next)[u];
-            path->push_back(edge);
+            path->push_back(gl->sample_parallel_edge(edge, rng)); // concrete edge, if parallel edges are collapsed
             u = gl->edge_other_end(edge, u); // O(1)
         }
     }
 
-    RNG_END();
 
+    return IGRAPH_SUCCESS;
+}
+
+template<typename graph_t>
+int BasicRandomSpanningTrees<graph_t>::cycle_popping_get_st(std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree)
+{
+    const vid_t N = gl->vertex_count_all();
+
+    assert(gl->is_vertex_alive(root));
+
+    std::fill(in_tree->begin(), in_tree->end(), false);
+    (*in_tree)[root] = true;
+
+    walk_mark.assign(N, 0);
+    unsigned int stamp = 0;
+
+    path->clear();
+    path->reserve(gl->vertex_count()-1);
+
+    // top of the successor stack of every vertex
+    for (vid_t i = 0; i < N; i++)
+        if (i != root && gl->is_vertex_alive(i))
+            (*next)[i] = gl->random_incident_edge(i, rng);
+
+    for (vid_t i = 0; i < N; i++)
+    {
+        if (!gl->is_vertex_alive(i))
+            continue;
+
+        while(!(*in_tree)[i])
+        {
+            // follow the successors until the tree, or a vertex already on this walk
+            stamp++;
+            vid_t u = i;
+            while(!(*in_tree)[u] && walk_mark[u] != stamp)
+            {
+                walk_mark[u] = stamp;
+                u = gl->edge_other_end((*next)[u], u);
+            }
+
+            if ((*in_tree)[u])
+                break;
+
+            // u closes a cycle, pop it: every vertex on it moves to the next successor of its stack
+            vid_t w = u;
+            do{
+                const eid_t edge = (*next)[w];
+                (*next)[w] = gl->random_incident_edge(w, rng);
+                w = gl->edge_other_end(edge, w);
+            }while(w != u);
+        }
+
+        // the successors from i now lead to the tree
+        vid_t u = i;
+        while(!(*in_tree)[u])
+        {
+            (*in_tree)[u] = true;
+
+            eid_t edge = (*next)[u];
+            path->push_back(gl->sample_parallel_edge(edge, rng));
+            u = gl->edge_other_end(edge, u);
+        }
+    }
 
     return IGRAPH_SUCCESS;
 }
+
+template<typename graph_t>
+int BasicRandomSpanningTrees<graph_t>::aldous_broder_get_st(std::vector<eid_t> *path, vid_t root, std::vector<eid_t>* next, std::vector<bool>* in_tree)
+{
+    (void)next; // the walk needs no successor table
+
+    assert(gl->is_vertex_alive(root));
+
+    std::fill(in_tree->begin(), in_tree->end(), false);
+    (*in_tree)[root] = true;
+
+    const vid_t n = gl->vertex_count();
+
+    path->clear();
+    path->reserve(n-1);
+
+    vid_t u = root;
+    for (vid_t visited = 1; visited < n; )
+    {
+        eid_t edge = gl->random_incident_edge(u, rng);
+        u = gl->edge_other_end(edge, u);
+
+        // first entrance into u
+        if (!(*in_tree)[u])
+        {
+            (*in_tree)[u] = true;
+            path->push_back(gl->sample_parallel_edge(edge, rng));
+            visited++;
+        }
+    }
+
+    return IGRAPH_SUCCESS;
+}
+
+template<typename graph_t>
+int BasicRandomSpanningTrees<graph_t>::wilsons_get_st_interleaved(int G, vid_t root)
+{
+    const vid_t N = gl->vertex_count_all();
+
+    assert(G > 0 && gl->is_vertex_alive(root));
+
+    walkers.resize(G);
+    for (auto& w : walkers)
+    {
+        w.path.clear();
+        w.path.reserve(gl->vertex_count()-1);
+        w.next.resize(N);
+        w.in_tree.assign(N, false);
+        w.in_tree[root] = true;
+        w.i = graph_t::NO_VERTEX; // wraps to 0 on the first increment
+        w.stage = walker_t::NEXT_START;
+    }
+
+    int active = G;
+    while (active)
+    {
+        for (auto& w : walkers)
+        {
+            switch (w.stage)
+            {
+                case walker_t::NEXT_START:
+                    // next vertex not in the tree yet
+                    do{
+                        w.i++;
+                    }while(w.i < N && (!gl->is_vertex_alive(w.i) || w.in_tree[w.i]));
+
+                    if (w.i == N){
+                        w.stage = walker_t::DONE;
+                        active--;
+                        break;
+                    }
+                    w.u = w.i;
+                    w.stage = walker_t::WALK_SLOT;
+                    break;
+
+                case walker_t::WALK_SLOT:
+                    gl->prefetch_slot(w.u);
+                    w.stage = walker_t::WALK_LIST;
+                    break;
+
+                case walker_t::WALK_LIST:
+                    gl->prefetch_incident(w.u);
+                    w.stage = walker_t::WALK_EDGE;
+                    break;
+
+                case walker_t::WALK_EDGE:
+                    w.e = gl->random_incident_edge(w.u, rng);
+                    w.next[w.u] = w.e;
+                    gl->prefetch_edge(w.e);
+                    w.stage = walker_t::WALK_MOVE;
+                    break;
+
+                case walker_t::WALK_MOVE:
+                    w.u = gl->edge_other_end(w.e, w.u);
+                    if (!w.in_tree[w.u]){
+                        w.stage = walker_t::WALK_SLOT;
+                        break;
+                    }
+
+                    // collecting the walked path
+                    w.u = w.i;
+                    while (!w.in_tree[w.u])
+                    {
+                        w.in_tree[w.u] = true;
+
+                        eid_t edge = w.next[w.u];
+                        w.path.push_back(gl->sample_parallel_edge(edge, rng));
+                        w.u = gl->edge_other_end(edge, w.u);
+                    }
+                    w.stage = walker_t::NEXT_START;
+                    break;
+
+                case walker_t::DONE:
+                    break;
+            }
+        }
+    }
+
+    for (auto& w : walkers)
+    {
+        buffered.emplace_back();
+        buffered.back().swap(w.path);
+    }
+
+    return IGRAPH_SUCCESS;
+}
+
+template class BasicRandomSpanningTrees<GraphLite>;
+template class BasicRandomSpanningTrees<GraphLite64>;
@@ -0,0 +1,113 @@
+#include <trial_scheduler.hpp>
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <cmath>
+
+unsigned long TrialScheduler::trial_seed(int trial) const
+{
+    // decorrelate the streams of consecutive trial indices
+    std::seed_seq seq{(unsigned int)(seed & 0xffffffff), (unsigned int)(seed >> 32), (unsigned int)trial};
+    unsigned long s[2];
+    seq.generate(s, s + 2);
+    return s[0] << 32 ^ s[1];
+}
+
+std::vector<TrialScheduler::trial_result_t> TrialScheduler::run(int L, const callback_t& on_complete)
+{
+    assert(num_threads > 0);
+    std::vector<trial_result_t> results(L);
+
+    std::atomic<int> next_trial(0);
+    std::mutex callback_mutex;
+
+    auto run_begin = std::chrono::steady_clock::now();
+
+    auto worker = [&](int w){
+        if(pin_threads){
+            int cpu = 0;
+            topology.spread(w, &cpu);
+            NumaTopology::pin_this_thread(cpu);
+        }
+
+        // private working copy, touched first by the worker thread, and reused by all its trials
+        GraphLite gl = *base;
+        gl.release_journal();
+        const GraphLite::checkpoint_t gl_base = gl.checkpoint();
+
+        for (int l = next_trial++; l < L; l = next_trial++){
+
+            auto begin = std::chrono::steady_clock::now();
+
+            auto ast = std::make_unique<ApproxCountST>(&gl, trial_seed(l));
+            results[l].res = ast->approx_count_st(budget);
+            ast.reset();
+
+            auto end = std::chrono::steady_clock::now();
+
+            results[l].trial = l;
+            results[l].worker = w;
+            results[l].seconds = std::chrono::duration<double>(end - begin).count();
+
+            gl.rollback(gl_base);
+
+            if(on_complete){
+                std::lock_guard<std::mutex> lock(callback_mutex);
+                on_complete(results[l]);
+            }
+        }
+    };
+
+    if(num_threads == 1 && !pin_threads)
+        worker(0);
+    else{
+        std::vector<std::thread> pool;
+        for(int w = 0; w < num_threads; w++)
+            pool.emplace_back(worker, w);
+        for(auto& t : pool)
+            t.join();
+    }
+
+    auto run_end = std::chrono::steady_clock::now();
+
+    run_seconds = std::chrono::duration<double>(run_end - run_begin).count();
+
+    return results;
+}
+
+TrialScheduler::summary_t TrialScheduler::summarise(const std::vector<trial_result_t>& results, double ref_count_log) const
+{
+    summary_t s;
+    s.trials = results.size();
+    s.total_seconds = run_seconds;
+    if(!s.trials)
+        return s;
+
+    for(auto& r : results){
+        s.mean_count_log += r.res.count_log;
+        s.mean_error += std::exp(r.res.count_log - ref_count_log) - 1.0;
+        s.mean_seconds += r.seconds;
+        s.mean_actual_samples += r.res.actual_samples;
+    }
+    s.mean_count_log /= s.trials;
+    s.mean_error /= s.trials;
+    s.mean_seconds /= s.trials;
+    s.mean_actual_samples /= s.trials;
+
+    if(s.trials > 1){
+        for(auto& r : results){
+            double d = r.res.count_log - s.mean_count_log;
+            s.var_count_log += d * d;
+            d = std::exp(r.res.count_log - ref_count_log) - 1.0 - s.mean_error;
+            s.var_error += d * d;
+        }
+        s.var_count_log /= s.trials - 1;
+        s.var_error /= s.trials - 1;
+    }
+
+    return s;
+}